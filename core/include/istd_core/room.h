@@ -10,11 +10,11 @@ namespace istd {
 
 // A Room <-> a chunk in tilemap
 class Room {
-	std::uint8_t chunk_x_, chunk_y_;
+	ChunkCoord chunk_x_, chunk_y_;
 	SmallMap<std::tuple<std::uint8_t, std::uint8_t>, entt::entity> structures_;
 
 public:
-	Room(std::uint8_t chunk_x, std::uint8_t chunk_y);
+	Room(ChunkCoord chunk_x, ChunkCoord chunk_y);
 
 	TilePos tilepos_of(std::uint8_t local_x, std::uint8_t local_y) const {
 		return {chunk_x_, chunk_y_, local_x, local_y};
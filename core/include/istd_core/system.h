@@ -1,18 +1,139 @@
 #ifndef ISTD_CORE_SYSTEM_H
 #define ISTD_CORE_SYSTEM_H
 
+#include "istd_core/system_profiler.h"
 #include "istd_core/world.h"
+#include "tilemap/worker_pool.h"
+#include <cstddef>
 #include <cstdint>
+#include <entt/entt.hpp>
 #include <string_view>
-#include <tuple>
+#include <type_traits>
 #include <vector>
 
 namespace istd {
 
+/**
+ * @brief World state that is not stored in components
+ */
+enum class WorldState : std::uint8_t {
+	Tick = 1 << 0,    // World::tick
+	Tilemap = 1 << 1, // World::tilemap
+	Rooms = 1 << 2,   // World::rooms
+};
+
+/**
+ * @brief The state a system reads and writes, used to schedule systems
+ *
+ * Two systems conflict if one writes a component or world state the other
+ * reads or writes, or if either is exclusive. Systems that create or destroy
+ * entities, or add or remove components, change the registry structure and
+ * must be exclusive.
+ */
+class SystemAccess {
+private:
+	// Returns the size of the storage of a component, creating it if needed
+	using StorageSize = std::size_t (*)(entt::registry &);
+
+	std::vector<entt::id_type> reads_;
+	std::vector<entt::id_type> writes_;
+	std::vector<StorageSize> storages_; // One per declared component
+	std::uint8_t world_reads_ = 0;
+	std::uint8_t world_writes_ = 0;
+	bool exclusive_ = false;
+
+	template<typename Component>
+	void add(std::vector<entt::id_type> &ids) {
+		using Type = std::remove_const_t<Component>;
+		ids.push_back(entt::type_hash<Type>::value());
+		storages_.push_back([](entt::registry &registry) -> std::size_t {
+			return registry.storage<Type>().size();
+		});
+	}
+
+public:
+	/**
+	 * @brief Access that conflicts with every other system
+	 */
+	static SystemAccess exclusive() {
+		SystemAccess access;
+		access.exclusive_ = true;
+		return access;
+	}
+
+	/**
+	 * @brief Declare components the system reads
+	 */
+	template<typename... Components>
+	SystemAccess &read() {
+		(add<Components>(reads_), ...);
+		return *this;
+	}
+
+	/**
+	 * @brief Declare components the system reads and writes
+	 */
+	template<typename... Components>
+	SystemAccess &write() {
+		(add<Components>(writes_), ...);
+		return *this;
+	}
+
+	/**
+	 * @brief Declare world state the system reads
+	 */
+	SystemAccess &read(WorldState state) noexcept {
+		world_reads_ |= static_cast<std::uint8_t>(state);
+		return *this;
+	}
+
+	/**
+	 * @brief Declare world state the system reads and writes
+	 */
+	SystemAccess &write(WorldState state) noexcept {
+		world_writes_ |= static_cast<std::uint8_t>(state);
+		return *this;
+	}
+
+	bool is_exclusive() const noexcept {
+		return exclusive_;
+	}
+
+	/**
+	 * @brief Check if two systems may not run at the same time
+	 */
+	bool conflicts_with(const SystemAccess &other) const noexcept;
+
+	/**
+	 * @brief Create the storage of every declared component
+	 *
+	 * Looking up a missing storage creates it, which must not happen while
+	 * systems run in parallel.
+	 */
+	void prepare(entt::registry &registry) const;
+
+	/**
+	 * @brief Get the number of entities in the smallest storage of the
+	 * declared components, which bounds the entities a view over them
+	 * visits; 0 if no components are declared
+	 */
+	std::size_t entity_count(entt::registry &registry) const;
+};
+
 struct System {
 	virtual void tick(World &world) const = 0;
 	virtual std::string_view name() const noexcept = 0; // for debugging
 
+	/**
+	 * @brief Declare the state the system reads and writes
+	 *
+	 * Called once on registration. Systems that do not override it run
+	 * alone.
+	 */
+	virtual SystemAccess access() const {
+		return SystemAccess::exclusive();
+	}
+
 	// No virtual destructor: static lifetime and no member variables is the
 	// intended use case
 
@@ -27,24 +148,71 @@ struct System {
 	};
 };
 
+/**
+ * @brief Registry of all systems and the schedule they run in
+ *
+ * A system runs after every conflicting system of higher precedence (or of
+ * equal precedence registered before it), and systems that do not conflict
+ * are unordered. The schedule groups the systems into stages: every system is
+ * placed in the stage after the last stage holding a system it must follow,
+ * so the systems of a stage can run in parallel.
+ */
 class SystemRegistry {
 public:
+	// Systems that may run at the same time
+	using Stage = std::vector<const System *>;
+
 	static SystemRegistry &instance() noexcept;
 
 	void register_system(
 		std::uint32_t precedence, const System *system
 	) noexcept;
 
-	void tick(World &world) const noexcept;
+	/**
+	 * @brief Run all systems one after another in precedence order
+	 * @param world The world to update
+	 * @param profiler If not null, record the wall time of every system and
+	 * of the whole tick
+	 */
+	void tick(World &world, SystemProfiler *profiler = nullptr) const noexcept;
+
+	/**
+	 * @brief Run the systems stage by stage, the systems of a stage in
+	 * parallel on a worker pool
+	 * @param world The world to update
+	 * @param pool Worker pool to run the stages on
+	 * @param profiler If not null, record the wall time of every system and
+	 * of the whole tick
+	 */
+	void tick(
+		World &world, WorkerPool &pool, SystemProfiler *profiler = nullptr
+	) const noexcept;
+
+	/**
+	 * @brief Get the stages of the schedule in run order
+	 */
+	std::vector<Stage> stages() const;
 
 	struct Registar {
 		Registar(std::uint32_t precedence, const System *system);
 	};
 
 private:
-	std::vector<std::tuple<std::uint32_t, const System *>> systems_;
+	struct Entry {
+		std::uint32_t precedence;
+		const System *system;
+		SystemAccess access;
+	};
+
+	std::vector<Entry> systems_; // In precedence order
+	std::vector<std::vector<std::size_t>> stages_; // Indices into systems_
+
+	void build_stages();
+	void run_system(
+		World &world, std::size_t index, SystemProfiler *profiler
+	) const noexcept;
 };
 
 } // namespace istd
 
-#endif
\ No newline at end of file
+#endif
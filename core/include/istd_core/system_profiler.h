@@ -0,0 +1,163 @@
+#ifndef ISTD_CORE_SYSTEM_PROFILER_H
+#define ISTD_CORE_SYSTEM_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace istd {
+
+/**
+ * @brief Wall time statistics over the last ticks of a profiler window
+ */
+struct TimingStats {
+	std::chrono::nanoseconds last{0};
+	std::chrono::nanoseconds p50{0};
+	std::chrono::nanoseconds p99{0};
+	std::chrono::nanoseconds max{0};
+};
+
+/**
+ * @brief Measurements of one system
+ */
+struct SystemTiming {
+	std::string_view name;
+	TimingStats wall_time;
+	// Entities in the smallest storage of the components the system declares,
+	// i.e. at most the entities its views visit; 0 without components
+	std::size_t entities = 0;
+};
+
+/**
+ * @brief Per-system tick profiler, filled by SystemRegistry::tick()
+ *
+ * Keeps the wall times of the last window_size() ticks of every system and
+ * of the whole tick in ring buffers, so the percentiles follow recent load
+ * rather than the whole run. Recording only writes the slot of the system
+ * that ran, so systems running in parallel do not contend. Statistics are
+ * computed in a scratch buffer reserved up front, so querying them on the
+ * tick thread, e.g. from a budget handler, does not allocate; queries must
+ * not run concurrently with each other or with a tick.
+ */
+class SystemProfiler {
+public:
+	/**
+	 * @brief Called after a tick that took longer than the budget, on the
+	 * thread running the tick
+	 */
+	using BudgetHandler = std::function<void(const SystemProfiler &)>;
+
+private:
+	// Ring buffer of the wall times of the last window_ samples
+	struct Series {
+		std::vector<std::chrono::nanoseconds> samples;
+		std::size_t next = 0; // Slot the next sample overwrites once full
+		std::chrono::nanoseconds last{0};
+
+		void record(std::chrono::nanoseconds time, std::size_t window);
+		TimingStats stats(std::vector<std::chrono::nanoseconds> &scratch) const;
+	};
+
+	struct Slot {
+		std::string_view name;
+		Series series;
+		std::size_t entities = 0;
+	};
+
+	std::size_t window_;
+	std::vector<Slot> systems_; // In SystemRegistry order
+	Series ticks_;
+	std::uint32_t last_tick_ = 0;
+	std::uint64_t over_budget_ticks_ = 0;
+	std::chrono::nanoseconds budget_{0};
+	BudgetHandler handler_;
+	// Copy of one series for selecting percentiles, reserved to window_
+	mutable std::vector<std::chrono::nanoseconds> scratch_;
+
+	friend class SystemRegistry;
+
+	void begin_tick(std::size_t system_count);
+	void record_system(
+		std::size_t index, std::string_view name,
+		std::chrono::nanoseconds time, std::size_t entities
+	) noexcept;
+	void end_tick(std::uint32_t tick, std::chrono::nanoseconds time) noexcept;
+
+public:
+	/**
+	 * @brief Construct a profiler
+	 * @param window_size Number of recent ticks the statistics cover
+	 */
+	explicit SystemProfiler(std::size_t window_size = 1024);
+
+	std::size_t window_size() const noexcept {
+		return window_;
+	}
+
+	/**
+	 * @brief Set the wall time a tick should stay within
+	 * @param budget Tick budget, 0 to disable the check
+	 * @param handler Called after every tick over budget; if null, the
+	 * profile is dumped to std::clog. The tick itself is noexcept, so any
+	 * exception the handler or the dump throws is caught and dropped.
+	 */
+	void set_tick_budget(
+		std::chrono::nanoseconds budget, BudgetHandler handler = nullptr
+	);
+
+	std::chrono::nanoseconds tick_budget() const noexcept {
+		return budget_;
+	}
+
+	/**
+	 * @brief Get the number of recorded ticks that went over budget
+	 */
+	std::uint64_t over_budget_ticks() const noexcept {
+		return over_budget_ticks_;
+	}
+
+	/**
+	 * @brief Get World::tick after the last recorded tick
+	 */
+	std::uint32_t last_tick() const noexcept {
+		return last_tick_;
+	}
+
+	/**
+	 * @brief Get the statistics of whole ticks
+	 */
+	TimingStats tick_stats() const {
+		return ticks_.stats(scratch_);
+	}
+
+	/**
+	 * @brief Get the measurements of every system in registry order
+	 */
+	std::vector<SystemTiming> systems() const;
+
+	/**
+	 * @brief Find the measurements of a system by name
+	 * @return The measurements, or zeros if no system has that name
+	 */
+	SystemTiming find(std::string_view name) const;
+
+	/**
+	 * @brief Write the tick and system statistics as a table
+	 *
+	 * Formats straight into the stream without building the systems()
+	 * vector.
+	 */
+	void dump(std::ostream &out) const;
+
+	/**
+	 * @brief Drop all recorded samples
+	 */
+	void reset() noexcept;
+};
+
+} // namespace istd
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "entt/entt.hpp"
 #include "istd_util/vec2.h"
+#include "tilemap/chunk.h"
 #include <vector>
 
 namespace istd {
@@ -14,7 +15,7 @@ namespace istd {
  * @brief Component to unit identification.
  */
 struct UnitIdComponent {
-	std::uint8_t room_x, room_y;
+	ChunkCoord room_x, room_y;
 	std::uint8_t unit_id;
 };
 
@@ -3,6 +3,7 @@
 
 #include "istd_core/room.h"
 #include "tilemap/generation.h"
+#include "tilemap/generation_cache.h"
 #include "tilemap/tilemap.h"
 #include <vector>
 
@@ -14,9 +15,15 @@ struct World {
 	std::vector<std::vector<Room>> rooms;
 	entt::registry registry;
 
-	World(std::uint8_t size);
+	World(ChunkCoord size);
 
 	void generateTilemap(const GenerationConfig &config);
+
+	// Load the tilemap from the cache, generating and storing it on a miss.
+	// Returns true on a cache hit.
+	bool generateTilemap(
+		const GenerationConfig &config, const GenerationCache &cache
+	);
 };
 
 } // namespace istd
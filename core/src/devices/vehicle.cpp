@@ -147,6 +147,12 @@ struct VehicleVelocitySystem : public System {
 	std::string_view name() const noexcept override {
 		return "Vehicle Device System";
 	}
+
+	SystemAccess access() const override {
+		return SystemAccess()
+			.read<VehicleComponent, DeviceIdComponent, OnGroundFlag>()
+			.write<KinematicsComponent>();
+	}
 };
 
 static const VehicleVelocitySystem vehicle_velocity_system;
@@ -1,8 +1,46 @@
 #include "istd_core/system.h"
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
 
 namespace istd {
 
+bool SystemAccess::conflicts_with(const SystemAccess &other) const noexcept {
+	if (exclusive_ || other.exclusive_) {
+		return true;
+	}
+	if ((world_writes_ & (other.world_reads_ | other.world_writes_))
+	    || (other.world_writes_ & world_reads_)) {
+		return true;
+	}
+
+	auto overlaps = [](const std::vector<entt::id_type> &a,
+	                   const std::vector<entt::id_type> &b) {
+		return std::ranges::any_of(a, [&b](entt::id_type id) {
+			return std::ranges::find(b, id) != b.end();
+		});
+	};
+	return overlaps(writes_, other.reads_) || overlaps(writes_, other.writes_)
+		|| overlaps(reads_, other.writes_);
+}
+
+void SystemAccess::prepare(entt::registry &registry) const {
+	for (StorageSize storage_size : storages_) {
+		storage_size(registry);
+	}
+}
+
+std::size_t SystemAccess::entity_count(entt::registry &registry) const {
+	if (storages_.empty()) {
+		return 0;
+	}
+	std::size_t count = SIZE_MAX;
+	for (StorageSize storage_size : storages_) {
+		count = std::min(count, storage_size(registry));
+	}
+	return count;
+}
+
 SystemRegistry &SystemRegistry::instance() noexcept {
 	static SystemRegistry registry;
 	return registry;
@@ -11,21 +49,105 @@ SystemRegistry &SystemRegistry::instance() noexcept {
 void SystemRegistry::register_system(
 	std::uint32_t precedence, const System *system
 ) noexcept {
-	auto cmp = [](const std::tuple<std::uint32_t, const System *> &a,
-	              std::uint32_t b) {
-		return std::get<0>(a) < b;
-	};
+	// Systems of equal precedence keep their registration order
+	auto it = std::ranges::upper_bound(
+		systems_, precedence, {}, &Entry::precedence
+	);
+	systems_.insert(it, {precedence, system, system->access()});
+	build_stages();
+}
 
-	auto it = std::lower_bound(
-		systems_.begin(), systems_.end(), precedence, cmp
+void SystemRegistry::build_stages() {
+	stages_.clear();
+	std::vector<std::size_t> stage_of(systems_.size());
+	for (std::size_t i = 0; i < systems_.size(); ++i) {
+		std::size_t stage = 0;
+		for (std::size_t j = 0; j < i; ++j) {
+			if (systems_[i].access.conflicts_with(systems_[j].access)) {
+				stage = std::max(stage, stage_of[j] + 1);
+			}
+		}
+		stage_of[i] = stage;
+		if (stage == stages_.size()) {
+			stages_.emplace_back();
+		}
+		stages_[stage].push_back(i);
+	}
+}
+
+std::vector<SystemRegistry::Stage> SystemRegistry::stages() const {
+	std::vector<Stage> stages;
+	for (const auto &indices : stages_) {
+		Stage &stage = stages.emplace_back();
+		for (std::size_t index : indices) {
+			stage.push_back(systems_[index].system);
+		}
+	}
+	return stages;
+}
+
+void SystemRegistry::run_system(
+	World &world, std::size_t index, SystemProfiler *profiler
+) const noexcept {
+	const Entry &entry = systems_[index];
+	if (!profiler) {
+		entry.system->tick(world);
+		return;
+	}
+
+	const std::size_t entities = entry.access.entity_count(world.registry);
+	const auto start = std::chrono::steady_clock::now();
+	entry.system->tick(world);
+	profiler->record_system(
+		index, entry.system->name(), std::chrono::steady_clock::now() - start,
+		entities
 	);
+}
+
+void SystemRegistry::tick(
+	World &world, SystemProfiler *profiler
+) const noexcept {
+	const auto start = std::chrono::steady_clock::now();
+	if (profiler) {
+		profiler->begin_tick(systems_.size());
+	}
 
-	systems_.insert(it, std::make_tuple(precedence, system));
+	for (std::size_t i = 0; i < systems_.size(); ++i) {
+		run_system(world, i, profiler);
+	}
+
+	if (profiler) {
+		profiler->end_tick(
+			world.tick, std::chrono::steady_clock::now() - start
+		);
+	}
 }
 
-void SystemRegistry::tick(World &world) const noexcept {
-	for (const auto &[_, system] : systems_) {
-		system->tick(world);
+void SystemRegistry::tick(
+	World &world, WorkerPool &pool, SystemProfiler *profiler
+) const noexcept {
+	const auto start = std::chrono::steady_clock::now();
+	if (profiler) {
+		profiler->begin_tick(systems_.size());
+	}
+	for (const Entry &entry : systems_) {
+		entry.access.prepare(world.registry);
+	}
+
+	for (const auto &stage : stages_) {
+		if (stage.size() == 1) {
+			run_system(world, stage.front(), profiler);
+			continue;
+		}
+		pool.parallel_for(stage.size(), [&](std::uint32_t i) {
+			run_system(world, stage[i], profiler);
+		});
+	}
+
+	if (profiler) {
+		profiler->end_tick(
+			world.tick, std::chrono::steady_clock::now() - start
+		);
 	}
 }
 
@@ -35,4 +157,4 @@ SystemRegistry::Registar::Registar(
 	SystemRegistry::instance().register_system(precedence, system);
 }
 
-} // namespace istd
\ No newline at end of file
+} // namespace istd
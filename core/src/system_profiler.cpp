@@ -0,0 +1,171 @@
+#include "istd_core/system_profiler.h"
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <iterator>
+
+namespace istd {
+
+namespace {
+
+// Nearest-rank percentile of unsorted samples, reordering them
+std::chrono::nanoseconds percentile(
+	std::vector<std::chrono::nanoseconds> &samples, std::size_t percent
+) {
+	const std::size_t rank = (samples.size() * percent + 99) / 100;
+	auto nth = samples.begin() + std::max<std::size_t>(rank, 1) - 1;
+	std::ranges::nth_element(samples, nth);
+	return *nth;
+}
+
+double to_microseconds(std::chrono::nanoseconds time) {
+	return std::chrono::duration<double, std::micro>(time).count();
+}
+
+} // namespace
+
+void SystemProfiler::Series::record(
+	std::chrono::nanoseconds time, std::size_t window
+) {
+	if (samples.size() < window) {
+		samples.push_back(time);
+	} else {
+		samples[next] = time;
+		next = (next + 1) % window;
+	}
+	last = time;
+}
+
+TimingStats SystemProfiler::Series::stats(
+	std::vector<std::chrono::nanoseconds> &scratch
+) const {
+	TimingStats stats;
+	if (samples.empty()) {
+		return stats;
+	}
+	stats.last = last;
+	stats.max = std::ranges::max(samples);
+
+	// Never allocates, the scratch buffer is reserved to the window size
+	scratch.assign(samples.begin(), samples.end());
+	stats.p50 = percentile(scratch, 50);
+	stats.p99 = percentile(scratch, 99);
+	return stats;
+}
+
+SystemProfiler::SystemProfiler(std::size_t window_size)
+	: window_(std::max<std::size_t>(window_size, 1)) {
+	ticks_.samples.reserve(window_);
+	scratch_.reserve(window_);
+}
+
+void SystemProfiler::begin_tick(std::size_t system_count) {
+	// Systems only register during static initialization, so this allocates
+	// on the first tick only
+	if (systems_.size() != system_count) {
+		systems_.resize(system_count);
+		for (Slot &slot : systems_) {
+			slot.series.samples.reserve(window_);
+		}
+	}
+}
+
+void SystemProfiler::record_system(
+	std::size_t index, std::string_view name, std::chrono::nanoseconds time,
+	std::size_t entities
+) noexcept {
+	Slot &slot = systems_[index];
+	slot.name = name;
+	slot.entities = entities;
+	// Never allocates, the buffer is reserved to the window size
+	slot.series.record(time, window_);
+}
+
+void SystemProfiler::end_tick(
+	std::uint32_t tick, std::chrono::nanoseconds time
+) noexcept {
+	// Never allocates, the buffer is reserved to the window size
+	ticks_.record(time, window_);
+	last_tick_ = tick;
+	if (budget_.count() == 0 || time <= budget_) {
+		return;
+	}
+
+	++over_budget_ticks_;
+	// A failing report must not take the tick, and the server, down with it
+	try {
+		if (handler_) {
+			handler_(*this);
+		} else {
+			dump(std::clog);
+		}
+	} catch (...) {
+	}
+}
+
+void SystemProfiler::set_tick_budget(
+	std::chrono::nanoseconds budget, BudgetHandler handler
+) {
+	budget_ = budget;
+	handler_ = std::move(handler);
+}
+
+std::vector<SystemTiming> SystemProfiler::systems() const {
+	std::vector<SystemTiming> timings;
+	timings.reserve(systems_.size());
+	for (const Slot &slot : systems_) {
+		timings.push_back({
+			slot.name, slot.series.stats(scratch_), slot.entities
+		});
+	}
+	return timings;
+}
+
+SystemTiming SystemProfiler::find(std::string_view name) const {
+	auto it = std::ranges::find(systems_, name, &Slot::name);
+	if (it == systems_.end()) {
+		return {name};
+	}
+	return {it->name, it->series.stats(scratch_), it->entities};
+}
+
+void SystemProfiler::dump(std::ostream &out) const {
+	std::ostreambuf_iterator<char> sink(out);
+	const TimingStats ticks = ticks_.stats(scratch_);
+	std::format_to(
+		sink, "Tick {}: {:.1f} us (budget {:.1f} us, {} over budget)\n",
+		last_tick_, to_microseconds(ticks.last), to_microseconds(budget_),
+		over_budget_ticks_
+	);
+	std::format_to(
+		sink, "{:<32}{:>10}{:>10}{:>10}{:>10}{:>10}\n", "system (us)", "last",
+		"p50", "p99", "max", "entities"
+	);
+
+	auto row = [&sink](std::string_view name, const TimingStats &stats,
+	                   std::size_t entities) {
+		std::format_to(
+			sink, "{:<32}{:>10.1f}{:>10.1f}{:>10.1f}{:>10.1f}{:>10}\n", name,
+			to_microseconds(stats.last), to_microseconds(stats.p50),
+			to_microseconds(stats.p99), to_microseconds(stats.max), entities
+		);
+	};
+	for (const Slot &slot : systems_) {
+		row(slot.name, slot.series.stats(scratch_), slot.entities);
+	}
+	row("(tick)", ticks, 0);
+}
+
+void SystemProfiler::reset() noexcept {
+	for (Slot &slot : systems_) {
+		slot.series.samples.clear();
+		slot.series.next = 0;
+		slot.series.last = {};
+	}
+	ticks_.samples.clear();
+	ticks_.next = 0;
+	ticks_.last = {};
+	over_budget_ticks_ = 0;
+}
+
+} // namespace istd
@@ -1,7 +1,10 @@
 #include "istd_core/unit.h"
 #include "istd_core/system.h"
 #include "istd_util/tile_geometry.h"
-#include "tilemap/tile.h"
+#include "tilemap/tile_layers.h"
+#include <array>
+#include <cstdint>
+#include <optional>
 
 namespace istd {
 
@@ -20,6 +23,10 @@ struct ResetVelocitySystem : public System {
 	std::string_view name() const noexcept override {
 		return "Reset Velocity System";
 	}
+
+	SystemAccess access() const override {
+		return SystemAccess().write<KinematicsComponent>();
+	}
 };
 
 static const ResetVelocitySystem reset_velocity_system;
@@ -27,24 +34,77 @@ static const SystemRegistry::Registar reset_velocity_registrar(
 	System::Precedence::ResetVelocity, &reset_velocity_system
 );
 
-bool is_passible_tile(Tile tile) {
-	return tile.base != BaseTileType::Mountain;
+// Find the first impassable tile on a segment; tiles outside the map are
+// impassable. With tile layers, chunks without impassable tiles are jumped
+// over and the tiles of the others are tested against the cached layers of
+// their chunk.
+std::optional<std::array<std::int32_t, 2>> find_impassable_tile(
+	const TileMap &tilemap, Vec2 p1, Vec2 p2
+) {
+	const GlobalCoord extent = GlobalCoord(tilemap.get_size()) * Chunk::size;
+	if (!tilemap.has_layers()) {
+		auto is_blocked = [&](std::int32_t i, std::int32_t j) {
+			// Negative coordinates wrap around past the extent
+			const auto x = static_cast<GlobalCoord>(i);
+			const auto y = static_cast<GlobalCoord>(j);
+			return x >= extent || y >= extent
+				|| tilemap.tile_in_layer(TileLayer::Impassable, x, y);
+		};
+		return find_tile_on_segment(p1, p2, is_blocked);
+	}
+
+	constexpr std::int32_t chunk_mask = -std::int32_t(Chunk::size);
+	SegmentTileWalker walker(p1, p2);
+	auto tile = walker.tile();
+	while (true) {
+		// Entering a chunk; negative coordinates wrap around past the extent
+		const auto x = static_cast<GlobalCoord>(tile[0]);
+		const auto y = static_cast<GlobalCoord>(tile[1]);
+		if (x >= extent || y >= extent) {
+			return tile;
+		}
+		const ChunkLayers &layers = tilemap.get_chunk_layers_unchecked(
+			x / Chunk::size, y / Chunk::size
+		);
+
+		// A jump costs a few steps, and the occupancy bits are in another
+		// cache line than the row, so short walks just test their tiles
+		if (walker.remaining_steps() > Chunk::subchunk_size
+		    && !layers.any(TileLayer::Impassable)) {
+			if (!walker.skip_block(Chunk::size)) {
+				return std::nullopt;
+			}
+			tile = walker.tile();
+			continue;
+		}
+
+		const std::int32_t chunk_i = tile[0] & chunk_mask;
+		const std::int32_t chunk_j = tile[1] & chunk_mask;
+		do {
+			const std::uint64_t row = layers.row(
+				TileLayer::Impassable, tile[0] - chunk_i
+			);
+			if (row >> (tile[1] - chunk_j) & 1) {
+				return tile;
+			}
+			if (walker.done()) {
+				return std::nullopt;
+			}
+			walker.next();
+			tile = walker.tile();
+		} while ((tile[0] & chunk_mask) == chunk_i
+		         && (tile[1] & chunk_mask) == chunk_j);
+	}
 }
 
 void update_pos(const TileMap &tilemap, KinematicsComponent &kinematics) {
 	auto next_pos = kinematics.position + kinematics.velocity;
-	auto ray_cast = tiles_on_segment(kinematics.position, next_pos);
-	for (auto [i, j] : ray_cast) {
-		auto tile = tilemap.get_tile(TilePos::from_global(i, j));
-		if (!is_passible_tile(tile)) {
-			// Hit an impassable tile
-			// Calculate intersection point
-			auto inter = tile_segment_intersection(
-				kinematics.position, next_pos, {i, j}
-			);
-			next_pos = inter;
-			break;
-		}
+	auto hit = find_impassable_tile(tilemap, kinematics.position, next_pos);
+	if (hit) {
+		// Stop where the segment enters the impassable tile
+		next_pos = tile_segment_intersection(
+			kinematics.position, next_pos, *hit
+		);
 	}
 	kinematics.position = next_pos;
 }
@@ -52,16 +112,23 @@ void update_pos(const TileMap &tilemap, KinematicsComponent &kinematics) {
 struct KinematicsSystem : public System {
 	void tick(World &world) const noexcept override {
 		auto &reg = world.registry;
+		const TileMap &tilemap = world.tilemap;
 		reg.view<KinematicsComponent>().each(
-			std::bind(
-				update_pos, std::ref(world.tilemap), std::placeholders::_1
-			)
+			[&tilemap](KinematicsComponent &kinematics) {
+			update_pos(tilemap, kinematics);
+		}
 		);
 	}
 
 	std::string_view name() const noexcept override {
 		return "Kinematics System";
 	}
+
+	SystemAccess access() const override {
+		return SystemAccess()
+			.read(WorldState::Tilemap)
+			.write<KinematicsComponent>();
+	}
 };
 
 static const KinematicsSystem kinematics_system;
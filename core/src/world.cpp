@@ -14,6 +14,10 @@ struct TickSystem : public System {
 	std::string_view name() const noexcept override {
 		return "Tick System";
 	}
+
+	SystemAccess access() const override {
+		return SystemAccess().write(WorldState::Tick);
+	}
 };
 
 static const TickSystem tick_system;
@@ -23,10 +27,10 @@ static const SystemRegistry::Registar tick_registrar(
 
 } // namespace
 
-World::World(std::uint8_t size)
+World::World(ChunkCoord size)
 	: tick(0), tilemap(size), rooms(size, std::vector<Room>(size, {0, 0})) {
-	for (std::uint8_t x = 0; x < size; ++x) {
-		for (std::uint8_t y = 0; y < size; ++y) {
+	for (ChunkCoord x = 0; x < size; ++x) {
+		for (ChunkCoord y = 0; y < size; ++y) {
 			rooms[x][y] = {x, y};
 		}
 	}
@@ -34,6 +38,15 @@ World::World(std::uint8_t size)
 
 void World::generateTilemap(const GenerationConfig &config) {
 	map_generate(tilemap, config);
+	tilemap.enable_layers();
+}
+
+bool World::generateTilemap(
+	const GenerationConfig &config, const GenerationCache &cache
+) {
+	const bool hit = map_generate(tilemap, config, cache);
+	tilemap.enable_layers();
+	return hit;
 }
 
 } // namespace istd
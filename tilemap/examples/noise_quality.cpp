@@ -0,0 +1,73 @@
+#include "tilemap/noise.h"
+#include "tilemap/xoroshiro.h"
+#include <chrono>
+#include <cstdint>
+#include <print>
+#include <vector>
+
+// Speed comparison of the DiscreteRandomNoise backends. Their statistical
+// quality is checked by test/test_noise_quality.cpp.
+
+namespace {
+
+constexpr std::uint32_t grid_size = 256;
+
+const char *backend_name(istd::NoiseBackend backend) {
+	switch (backend) {
+	case istd::NoiseBackend::Permutation:
+		return "Permutation";
+	case istd::NoiseBackend::MultiplyXorshift:
+		return "MultiplyXorshift";
+	}
+	return "Unknown";
+}
+
+void benchmark(const istd::DiscreteRandomNoise &noise) {
+	using clock = std::chrono::steady_clock;
+	constexpr std::uint32_t count = grid_size * grid_size;
+
+	std::vector<istd::NoiseCoord> coords(count);
+	for (std::uint32_t i = 0; i < count; ++i) {
+		coords[i] = {i / grid_size, i % grid_size, 1};
+	}
+	std::vector<std::uint64_t> out(count);
+
+	std::uint64_t sink = 0;
+	auto start = clock::now();
+	for (const auto &coord : coords) {
+		sink ^= noise.noise(coord.x, coord.y, coord.z);
+	}
+	auto scalar_end = clock::now();
+	noise.noise_batch(coords, out);
+	auto batch_end = clock::now();
+	sink ^= out[count / 2];
+
+	auto ns_per_sample = [](auto duration) {
+		return std::chrono::duration<double, std::nano>(duration).count()
+			/ count;
+	};
+	std::println(
+		"  speed: noise() {:.2f} ns/sample, noise_batch() {:.2f} ns/sample "
+		"(checksum {:04x})",
+		ns_per_sample(scalar_end - start),
+		ns_per_sample(batch_end - scalar_end), sink & 0xFFFF
+	);
+}
+
+} // namespace
+
+int main() {
+	istd::Xoroshiro128PP rng(istd::Seed::from_string("noise_quality"));
+
+	for (auto backend :
+	     {istd::NoiseBackend::Permutation,
+	      istd::NoiseBackend::MultiplyXorshift}) {
+		istd::DiscreteRandomNoise noise(rng.jump_96(), backend);
+		rng = rng.jump_96();
+
+		std::println("{}:", backend_name(backend));
+		benchmark(noise);
+	}
+
+	return 0;
+}
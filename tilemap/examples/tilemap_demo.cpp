@@ -3,10 +3,41 @@
 #include "tilemap/generation.h"
 #include "tilemap/tile.h"
 #include "tilemap/tilemap.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
+#include <new>
 #include <print>
 #include <string>
+#include <thread>
+
+// Count heap allocations for the per-pass report
+namespace {
+std::atomic<std::uint64_t> allocation_count{0};
+std::atomic<std::uint64_t> allocation_bytes{0};
+
+istd::AllocationStats allocation_stats() {
+	return {allocation_count.load(), allocation_bytes.load()};
+}
+} // namespace
+
+void *operator new(std::size_t size) {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+	if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
 
 // Get BMP color for different tile types, considering surface tiles
 BmpColors::Color get_tile_color(const istd::Tile &tile) {
@@ -120,6 +151,29 @@ void generate_bmp(const istd::TileMap &tilemap, const std::string &filename) {
 	std::println("Chunks: {}x{}", chunks_per_side, chunks_per_side);
 }
 
+// Print the per-pass measurements of the generation pipeline
+void print_pass_report(const istd::PipelineReport &report) {
+	using milliseconds = std::chrono::duration<double, std::milli>;
+	const double total_ms = milliseconds(report.total_wall_time()).count();
+
+	std::println("\nPass Timings:");
+	std::println("=============");
+	std::println(
+		"{:>18} {:>10} {:>6} {:>10} {:>8} {:>8} {:>12}", "Pass", "Time (ms)",
+		"Share", "Tiles", "Biomes", "Allocs", "Alloc bytes"
+	);
+	for (const auto &pass : report.passes) {
+		double ms = milliseconds(pass.wall_time).count();
+		std::println(
+			"{:>18} {:>10.2f} {:>5.1f}% {:>10} {:>8} {:>8} {:>12}", pass.name,
+			ms, total_ms > 0 ? ms / total_ms * 100.0 : 0.0, pass.tiles_written,
+			pass.biomes_written, pass.allocations.count,
+			pass.allocations.bytes
+		);
+	}
+	std::println("{:>18} {:>10.2f}", "Total", total_ms);
+}
+
 // Print statistics about the generated map
 void print_statistics(const istd::TileMap &tilemap) {
 	int tile_counts[6] = {0};
@@ -198,9 +252,9 @@ void print_statistics(const istd::TileMap &tilemap) {
 					// Count mountain edge tiles for mineral statistics
 					if (tile.base == istd::BaseTileType::Mountain) {
 						istd::TilePos pos(chunk_x, chunk_y, tile_x, tile_y);
-						auto neighbors = tilemap.get_neighbors(pos);
 						bool is_edge = false;
-						for (const auto neighbor_pos : neighbors) {
+						for (const auto neighbor_pos :
+						     tilemap.neighbors_of(pos)) {
 							const auto &neighbor_tile = tilemap.get_tile(
 								neighbor_pos
 							);
@@ -345,6 +399,7 @@ int main(int argc, char *argv[]) {
 	// Configure generation parameters
 	istd::GenerationConfig config;
 	config.seed = seed;
+	config.threads = std::max(1u, std::thread::hardware_concurrency());
 
 	// Generate the map
 	std::println("Generating terrain...");
@@ -352,7 +407,10 @@ int main(int argc, char *argv[]) {
 	// Start timing
 	auto start_time = std::chrono::high_resolution_clock::now();
 
-	istd::map_generate(tilemap, config);
+	istd::TerrainGenerator generator(config);
+	generator.pipeline().set_allocation_probe(allocation_stats);
+	generator.pipeline().set_count_writes(true);
+	generator(tilemap);
 
 	// End timing and calculate duration
 	auto end_time = std::chrono::high_resolution_clock::now();
@@ -373,6 +431,8 @@ int main(int argc, char *argv[]) {
 		std::println("Map generation completed in {:.3f} seconds", seconds);
 	}
 
+	print_pass_report(generator.report());
+
 	// Generate BMP output
 	std::println("Creating BMP visualization...");
 	generate_bmp(tilemap, output_filename);
@@ -0,0 +1,281 @@
+#ifndef ISTD_TILEMAP_CELLULAR_AUTOMATON_H
+#define ISTD_TILEMAP_CELLULAR_AUTOMATON_H
+
+#include "tilemap/chunk.h"
+#include "tilemap/noise.h"
+#include "tilemap/tile.h"
+#include "tilemap/tilemap.h"
+#include "tilemap/worker_pool.h"
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <vector>
+
+namespace istd {
+
+/**
+ * @brief Neighborhood of a tile as seen by a cellular automaton rule
+ * @tparam Chebyshev If true, the 8-connected neighborhood, otherwise the
+ * 4-connected one
+ */
+template<bool Chebyshev>
+struct CANeighborhood {
+	static constexpr std::uint8_t capacity = Chebyshev ? 8 : 4;
+
+	// In-bounds neighbor tiles, in the same order as TileMap::neighbors_of()
+	std::array<Tile, capacity> tiles;
+	std::uint8_t size = 0;
+
+	// Number of neighbors per base / surface tile type
+	std::array<std::uint8_t, 16> base_count{};
+	std::array<std::uint8_t, 16> surface_count{};
+
+	void push_back(Tile tile) noexcept {
+		tiles[size++] = tile;
+		++base_count[static_cast<std::uint8_t>(tile.base)];
+		++surface_count[static_cast<std::uint8_t>(tile.surface)];
+	}
+
+	/**
+	 * @brief Check if some neighbors were dropped by the map boundary
+	 */
+	bool at_border() const noexcept {
+		return size < capacity;
+	}
+
+	std::uint8_t count(BaseTileType type) const noexcept {
+		return base_count[static_cast<std::uint8_t>(type)];
+	}
+
+	std::uint8_t count(SurfaceTileType type) const noexcept {
+		return surface_count[static_cast<std::uint8_t>(type)];
+	}
+};
+
+/**
+ * @brief Rule of a cellular automaton: maps a tile and its neighborhood in the
+ * previous generation to the tile in the next generation
+ */
+template<typename Rule, bool Chebyshev>
+concept CARule = requires(
+	const Rule &rule, TilePos pos, Tile tile,
+	const CANeighborhood<Chebyshev> &neighborhood
+) {
+	{ rule(pos, tile, neighborhood) } -> std::convertible_to<Tile>;
+};
+
+/**
+ * @brief Cellular automaton rule that also receives a noise sample of the tile
+ */
+template<typename Rule, bool Chebyshev>
+concept CANoiseRule = requires(
+	const Rule &rule, TilePos pos, Tile tile,
+	const CANeighborhood<Chebyshev> &neighborhood, std::uint64_t sample
+) {
+	{ rule(pos, tile, neighborhood, sample) } -> std::convertible_to<Tile>;
+};
+
+/**
+ * @brief Double-buffered cellular automaton stepping engine
+ *
+ * Each step snapshots the map into a flat row-major buffer, then evaluates the
+ * rule for every tile against the snapshot and writes changed tiles back into
+ * the map. Rows are distributed over a worker pool; since all reads go to the
+ * snapshot, the result does not depend on the thread count. Tiles are written
+ * through references, so tile layers of the map are not updated (see
+ * TileMap::enable_layers()).
+ */
+class CellularAutomaton {
+private:
+	// Noise samples of one row, reused by a stripe for all of its rows
+	struct NoiseScratch {
+		std::vector<NoiseCoord> coords;      // Coordinates to hash
+		std::vector<std::uint32_t> columns;  // Row index y of each coordinate
+		std::vector<std::uint64_t> hashed;   // Hashes of coords
+		std::vector<std::uint64_t> samples;  // Sample of every tile of the row
+	};
+
+	std::vector<Tile> front_; // Previous generation, row-major
+	std::uint32_t width_ = 0; // Map width in tiles
+	std::vector<NoiseScratch> scratch_; // One per row stripe
+
+	/**
+	 * @brief Copy the tiles of the map into the front buffer
+	 */
+	void snapshot(const TileMap &tilemap, WorkerPool &pool);
+
+	/**
+	 * @brief Snapshot the map and evaluate a rule on every tile
+	 *
+	 * The rows are split into one contiguous stripe per pool thread.
+	 * @param make_row_rule Called once per row x as make_row_rule(x, stripe),
+	 * returns the rule invoked as row_rule(pos, tile, neighborhood, y) for the
+	 * tiles of that row; all rows of a stripe run on the same thread
+	 */
+	template<bool Chebyshev, typename MakeRowRule>
+	void step_rows(
+		TileMap &tilemap, const MakeRowRule &make_row_rule, WorkerPool &pool
+	) {
+		snapshot(tilemap, pool);
+		const std::uint32_t stripes = pool.size();
+		pool.parallel_for(stripes, [&](std::uint32_t stripe) {
+			const std::uint32_t row_begin = width_ * stripe / stripes;
+			const std::uint32_t row_end = width_ * (stripe + 1) / stripes;
+			for (std::uint32_t x = row_begin; x < row_end; ++x) {
+				step_row<Chebyshev>(tilemap, x, make_row_rule(x, stripe));
+			}
+		});
+	}
+
+	/**
+	 * @brief Evaluate a row rule on every tile of row x of the snapshot
+	 */
+	template<bool Chebyshev, typename RowRule>
+	void step_row(TileMap &tilemap, std::uint32_t x, const RowRule &row_rule) {
+		constexpr int dx[] = {-1, 1, 0, 0, -1, 1, -1, 1};
+		constexpr int dy[] = {0, 0, -1, 1, -1, -1, 1, 1};
+
+		const int width = width_;
+		const Tile *row = front_.data() + std::size_t(x) * width;
+		for (int y = 0; y < width; ++y) {
+			CANeighborhood<Chebyshev> neighborhood;
+			for (int i = 0; i < CANeighborhood<Chebyshev>::capacity; ++i) {
+				int nx = static_cast<int>(x) + dx[i];
+				int ny = y + dy[i];
+				if (nx < 0 || nx >= width || ny < 0 || ny >= width) {
+					continue;
+				}
+				neighborhood.push_back(front_[std::size_t(nx) * width + ny]);
+			}
+
+			TilePos pos{
+				static_cast<ChunkCoord>(x / Chunk::size),
+				static_cast<ChunkCoord>(y / Chunk::size),
+				static_cast<std::uint8_t>(x % Chunk::size),
+				static_cast<std::uint8_t>(y % Chunk::size),
+			};
+			Tile next = row_rule(pos, row[y], neighborhood, y);
+			if (next != row[y]) {
+				// Rows run in parallel, set_tile_unchecked() would race on
+				// the layers
+				tilemap.get_tile_unchecked(pos) = next;
+			}
+		}
+	}
+
+public:
+	/**
+	 * @brief Advance the map by one generation
+	 * @tparam Chebyshev If true, use the 8-connected neighborhood, otherwise
+	 * the 4-connected one
+	 * @param tilemap The tilemap to evolve
+	 * @param rule Rule invoked as rule(pos, tile, neighborhood) for every tile;
+	 * it may run concurrently and must only read immutable state besides its
+	 * arguments
+	 * @param pool Worker pool to distribute rows on
+	 */
+	template<bool Chebyshev, typename Rule>
+	requires CARule<Rule, Chebyshev>
+	void step(TileMap &tilemap, const Rule &rule, WorkerPool &pool) {
+		auto make_row_rule = [&rule](std::uint32_t, std::uint32_t) {
+			return [&rule](
+				TilePos pos, Tile tile,
+				const CANeighborhood<Chebyshev> &neighborhood, int
+			) {
+				return rule(pos, tile, neighborhood);
+			};
+		};
+		step_rows<Chebyshev>(tilemap, make_row_rule, pool);
+	}
+
+	/**
+	 * @brief Advance the map by one generation, passing every tile its noise
+	 * sample noise.noise(world_x, world_y, z), see TileMap::world_coords()
+	 *
+	 * The samples of a row are hashed in one DiscreteRandomNoise::noise_batch()
+	 * call before the rule runs on it, into scratch buffers that each row
+	 * stripe reuses across rows and steps.
+	 * @param tilemap The tilemap to evolve
+	 * @param rule Rule invoked as rule(pos, tile, neighborhood, sample)
+	 * @param needs_sample Predicate invoked as needs_sample(pos, tile) on the
+	 * previous generation; tiles it rejects are not hashed and get sample 0
+	 * @param noise Noise to sample
+	 * @param z Z coordinate of the samples, usually the step index
+	 * @param pool Worker pool to distribute rows on
+	 */
+	template<bool Chebyshev, typename Rule, typename NeedsSample>
+	requires CANoiseRule<Rule, Chebyshev>
+		&& std::predicate<const NeedsSample &, TilePos, Tile>
+	void step(
+		TileMap &tilemap, const Rule &rule, const NeedsSample &needs_sample,
+		const DiscreteRandomNoise &noise, std::uint32_t z, WorkerPool &pool
+	) {
+		const std::uint32_t width = tilemap.get_size() * Chunk::size;
+		const auto [origin_x, origin_y] = tilemap.world_coords({0, 0, 0, 0});
+		scratch_.resize(pool.size());
+		for (NoiseScratch &scratch : scratch_) {
+			scratch.coords.reserve(width);
+			scratch.columns.reserve(width);
+			scratch.hashed.reserve(width);
+			scratch.samples.resize(width);
+		}
+
+		auto make_row_rule = [&](std::uint32_t x, std::uint32_t stripe) {
+			NoiseScratch &scratch = scratch_[stripe];
+			scratch.coords.clear();
+			scratch.columns.clear();
+			const Tile *row = front_.data() + std::size_t(x) * width;
+			for (std::uint32_t y = 0; y < width; ++y) {
+				TilePos pos{
+					static_cast<ChunkCoord>(x / Chunk::size),
+					static_cast<ChunkCoord>(y / Chunk::size),
+					static_cast<std::uint8_t>(x % Chunk::size),
+					static_cast<std::uint8_t>(y % Chunk::size),
+				};
+				scratch.samples[y] = 0;
+				if (needs_sample(pos, row[y])) {
+					scratch.coords.push_back({origin_x + x, origin_y + y, z});
+					scratch.columns.push_back(y);
+				}
+			}
+			scratch.hashed.resize(scratch.coords.size());
+			noise.noise_batch(scratch.coords, scratch.hashed);
+			for (std::size_t i = 0; i < scratch.columns.size(); ++i) {
+				scratch.samples[scratch.columns[i]] = scratch.hashed[i];
+			}
+
+			return [&rule, &samples = scratch.samples](
+				TilePos pos, Tile tile,
+				const CANeighborhood<Chebyshev> &neighborhood, int y
+			) {
+				return rule(pos, tile, neighborhood, samples[y]);
+			};
+		};
+		step_rows<Chebyshev>(tilemap, make_row_rule, pool);
+	}
+
+	/**
+	 * @brief Advance the map by one generation, passing every tile its noise
+	 * sample noise.noise(world_x, world_y, z)
+	 * @param tilemap The tilemap to evolve
+	 * @param rule Rule invoked as rule(pos, tile, neighborhood, sample)
+	 * @param noise Noise to sample
+	 * @param z Z coordinate of the samples, usually the step index
+	 * @param pool Worker pool to distribute rows on
+	 */
+	template<bool Chebyshev, typename Rule>
+	requires CANoiseRule<Rule, Chebyshev>
+	void step(
+		TileMap &tilemap, const Rule &rule, const DiscreteRandomNoise &noise,
+		std::uint32_t z, WorkerPool &pool
+	) {
+		auto every_tile = [](TilePos, Tile) {
+			return true;
+		};
+		step<Chebyshev>(tilemap, rule, every_tile, noise, z, pool);
+	}
+};
+
+} // namespace istd
+
+#endif
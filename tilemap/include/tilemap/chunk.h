@@ -21,11 +21,17 @@ struct SubChunkPos {
 	constexpr SubChunkPos(std::uint8_t x, std::uint8_t y): sub_x(x), sub_y(y) {}
 };
 
+// Chunk coordinate in a map; maps span up to 65535 chunks per side
+using ChunkCoord = std::uint16_t;
+
+// Global tile coordinate, chunk coordinate * Chunk::size + local coordinate
+using GlobalCoord = std::uint32_t;
+
 // Represents the position of a tile in the map, using chunk and local
-// coordinates
-struct TilePos {
-	uint8_t chunk_x;
-	uint8_t chunk_y;
+// coordinates. Padded to 8 bytes so that copies are single register moves.
+struct alignas(8) TilePos {
+	ChunkCoord chunk_x;
+	ChunkCoord chunk_y;
 	uint8_t local_x;
 	uint8_t local_y;
 
@@ -34,13 +40,13 @@ struct TilePos {
 	 * @param other Other TilePos to compare with
 	 * @return Squared distance between the two positions
 	 */
-	std::uint32_t sqr_distance_to(TilePos other) const;
+	std::uint64_t sqr_distance_to(TilePos other) const;
 
 	/**
 	 * @brief Convert TilePos to global coordinates
 	 * @return Pair of global X and Y coordinates
 	 */
-	std::pair<std::uint16_t, std::uint16_t> to_global() const;
+	std::pair<GlobalCoord, GlobalCoord> to_global() const;
 
 	/**
 	 * @brief Construct a TilePos from global coordinates
@@ -48,7 +54,7 @@ struct TilePos {
 	 * @param global_y Global Y coordinate
 	 * @return TilePos corresponding to the global coordinates
 	 */
-	static TilePos from_global(std::uint16_t global_x, std::uint16_t global_y);
+	static TilePos from_global(GlobalCoord global_x, GlobalCoord global_y);
 
 	/**
 	 * @brief Three-way comparison operator for TilePos
@@ -124,6 +130,26 @@ struct Chunk {
 	}
 };
 
+// Defined here rather than in chunk.cpp so that hot loops converting
+// coordinates keep TilePos in registers
+inline std::pair<GlobalCoord, GlobalCoord> TilePos::to_global() const {
+	return {
+		static_cast<GlobalCoord>(chunk_x) * Chunk::size + local_x,
+		static_cast<GlobalCoord>(chunk_y) * Chunk::size + local_y
+	};
+}
+
+inline TilePos TilePos::from_global(
+	GlobalCoord global_x, GlobalCoord global_y
+) {
+	return {
+		static_cast<ChunkCoord>(global_x / Chunk::size),
+		static_cast<ChunkCoord>(global_y / Chunk::size),
+		static_cast<std::uint8_t>(global_x % Chunk::size),
+		static_cast<std::uint8_t>(global_y % Chunk::size)
+	};
+}
+
 /**
  * @brief Get the starting tile coordinates for a sub-chunk
  * @param pos Sub-chunk position
@@ -136,10 +162,10 @@ std::pair<std::uint8_t, std::uint8_t> subchunk_to_tile_start(SubChunkPos pos);
 template<>
 struct std::hash<istd::TilePos> {
 	::std::size_t operator()(istd::TilePos pos) const {
-		return (static_cast<::std::size_t>(pos.chunk_x) << 24)
-			| (static_cast<::std::size_t>(pos.chunk_y) << 16)
-			| (static_cast<::std::size_t>(pos.local_x) << 8)
-			| static_cast<::std::size_t>(pos.local_y);
+		return (static_cast<::std::uint64_t>(pos.chunk_x) << 32)
+			| (static_cast<::std::uint64_t>(pos.chunk_y) << 16)
+			| (static_cast<::std::uint64_t>(pos.local_x) << 8)
+			| static_cast<::std::uint64_t>(pos.local_y);
 	}
 };
 
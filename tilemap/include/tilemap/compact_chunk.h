@@ -0,0 +1,223 @@
+#ifndef ISTD_TILEMAP_COMPACT_CHUNK_H
+#define ISTD_TILEMAP_COMPACT_CHUNK_H
+
+#include "tilemap/biome.h"
+#include "tilemap/chunk.h"
+#include "tilemap/tilemap.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace istd {
+
+/**
+ * @brief Chunk stored as a small tile palette with bit-packed indices
+ *
+ * A chunk with a single distinct tile stores just that tile, and reads of it
+ * take an O(1) path. Up to 16 distinct tiles are stored as 1, 2 or 4 bit
+ * indices into the palette; anything else, and any chunk that has been
+ * written to, is stored as a full Chunk.
+ */
+class CompactChunk {
+public:
+	static constexpr std::size_t tile_count = Chunk::size * Chunk::size;
+	static constexpr std::size_t biome_count = Chunk::subchunk_count
+		* Chunk::subchunk_count;
+	static constexpr std::size_t max_palette_size = 16;
+
+private:
+	std::uint8_t bits_ = 0; // Bits per palette index: 0 (uniform), 1, 2, 4
+	std::uint8_t palette_size_ = 1;
+	std::array<Tile, max_palette_size> palette_{};
+	std::vector<std::uint64_t> indices_; // Tile i at bit i * bits_
+
+	// Sub-chunk biomes, empty if all are biome_fill_
+	BiomeType biome_fill_{};
+	std::vector<BiomeType> biomes_;
+
+	std::unique_ptr<Chunk> full_; // Set for expanded chunks
+
+	void expand();
+
+public:
+	/**
+	 * @brief Construct a chunk filled with default tiles and biomes
+	 */
+	CompactChunk() = default;
+
+	/**
+	 * @brief Compress a chunk
+	 */
+	explicit CompactChunk(const Chunk &chunk);
+
+	/**
+	 * @brief Reassemble a palette-encoded chunk
+	 * @param palette Distinct tiles, 1 to 16 entries
+	 * @param indices Packed indices, tile (x * 64 + y) at bit
+	 * (x * 64 + y) * index_bits(palette.size())
+	 * @param biomes Sub-chunk biomes, row by row
+	 * @throws std::invalid_argument if the sizes do not match
+	 */
+	CompactChunk(
+		std::span<const Tile> palette, std::span<const std::uint64_t> indices,
+		std::span<const BiomeType> biomes
+	);
+
+	CompactChunk(const CompactChunk &other);
+	CompactChunk &operator=(const CompactChunk &other);
+	CompactChunk(CompactChunk &&) noexcept = default;
+	CompactChunk &operator=(CompactChunk &&) noexcept = default;
+
+	/**
+	 * @brief Get the number of bits per index for a palette size
+	 */
+	static std::uint8_t index_bits(std::size_t palette_size) noexcept;
+
+	/**
+	 * @brief Check if the chunk is stored as a full Chunk
+	 */
+	bool is_expanded() const noexcept {
+		return full_ != nullptr;
+	}
+
+	/**
+	 * @brief Check if every tile of the chunk is the same
+	 * @note Expanded chunks are never reported as uniform
+	 */
+	bool is_uniform() const noexcept {
+		return !full_ && bits_ == 0;
+	}
+
+	/**
+	 * @brief Get the palette, empty for expanded chunks
+	 */
+	std::span<const Tile> palette() const noexcept {
+		return {palette_.data(), full_ ? 0u : palette_size_};
+	}
+
+	/**
+	 * @brief Get the packed palette indices, empty for uniform or expanded
+	 * chunks
+	 */
+	std::span<const std::uint64_t> packed_indices() const noexcept {
+		return indices_;
+	}
+
+	/**
+	 * @brief Get a tile
+	 * @param local_x Local X coordinate, less than Chunk::size
+	 * @param local_y Local Y coordinate, less than Chunk::size
+	 */
+	Tile get_tile(std::uint8_t local_x, std::uint8_t local_y) const noexcept {
+		if (full_) {
+			return full_->tiles[local_x][local_y];
+		}
+		if (bits_ == 0) {
+			return palette_[0];
+		}
+		const std::uint32_t bit = (local_x * Chunk::size + local_y) * bits_;
+		const std::uint64_t index = indices_[bit / 64] >> (bit % 64);
+		return palette_[index & ((1u << bits_) - 1)];
+	}
+
+	/**
+	 * @brief Get the biome of a sub-chunk
+	 */
+	BiomeType get_biome(SubChunkPos pos) const noexcept {
+		if (full_) {
+			return full_->get_biome(pos);
+		}
+		if (biomes_.empty()) {
+			return biome_fill_;
+		}
+		return biomes_[pos.sub_x * Chunk::subchunk_count + pos.sub_y];
+	}
+
+	/**
+	 * @brief Set a tile, expanding the chunk unless the tile is unchanged
+	 */
+	void set_tile(std::uint8_t local_x, std::uint8_t local_y, Tile tile);
+
+	/**
+	 * @brief Set the biome of a sub-chunk, expanding the chunk unless the
+	 * biome is unchanged
+	 */
+	void set_biome(SubChunkPos pos, BiomeType biome);
+
+	/**
+	 * @brief Write the full chunk
+	 */
+	void decompress(Chunk &chunk) const;
+
+	/**
+	 * @brief Get the heap memory used by the chunk in bytes
+	 */
+	std::size_t heap_bytes() const noexcept;
+};
+
+/**
+ * @brief Read-mostly TileMap stored as CompactChunks
+ *
+ * Mostly uniform terrain such as open ocean takes a fraction of the memory of
+ * a TileMap; chunks expand to full arrays when written to.
+ */
+class CompactTileMap {
+private:
+	ChunkCoord size_;
+	std::vector<CompactChunk> chunks_; // Indexed x * size + y
+
+public:
+	/**
+	 * @brief Construct a map with n×n default chunks
+	 * @param size Number of chunks in each dimension (1 to
+	 * TileMap::max_size)
+	 */
+	explicit CompactTileMap(ChunkCoord size);
+
+	/**
+	 * @brief Compress a TileMap; missing chunks of an on-demand map are
+	 * compressed as default chunks
+	 */
+	explicit CompactTileMap(const TileMap &tilemap);
+
+	ChunkCoord get_size() const noexcept {
+		return size_;
+	}
+
+	/**
+	 * @brief Get a chunk
+	 * @throws std::out_of_range if the coordinates are outside the map
+	 */
+	CompactChunk &get_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y);
+	const CompactChunk &get_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y) const;
+
+	/**
+	 * @brief Get a tile
+	 * @throws std::out_of_range if the position is outside the map
+	 */
+	Tile get_tile(TilePos pos) const;
+
+	/**
+	 * @brief Set a tile, expanding its chunk if the tile changes
+	 * @throws std::out_of_range if the position is outside the map
+	 */
+	void set_tile(TilePos pos, Tile tile);
+
+	/**
+	 * @brief Decompress into a TileMap of the same size, allocating every
+	 * chunk of an on-demand map
+	 * @throws std::invalid_argument if the sizes differ
+	 */
+	void decompress(TileMap &tilemap) const;
+
+	/**
+	 * @brief Get the memory used by the map in bytes
+	 */
+	std::size_t memory_usage() const noexcept;
+};
+
+} // namespace istd
+
+#endif
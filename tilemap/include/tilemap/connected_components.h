@@ -0,0 +1,140 @@
+#ifndef ISTD_TILEMAP_CONNECTED_COMPONENTS_H
+#define ISTD_TILEMAP_CONNECTED_COMPONENTS_H
+
+#include "tilemap/chunk.h"
+#include "tilemap/tilemap.h"
+#include "tilemap/worker_pool.h"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace istd {
+
+/**
+ * @brief Lookup table telling for every possible Tile byte whether it matches
+ * a predicate
+ */
+using TileMask = std::array<bool, 256>;
+
+/**
+ * @brief Build a TileMask by evaluating a predicate on every Tile value
+ * @param pred Predicate taking a Tile and returning bool
+ */
+template<typename Pred>
+TileMask make_tile_mask(Pred pred) {
+	TileMask mask;
+	for (std::size_t i = 0; i < mask.size(); ++i) {
+		mask[i] = pred(std::bit_cast<Tile>(static_cast<std::uint8_t>(i)));
+	}
+	return mask;
+}
+
+/**
+ * @brief Horizontal run of matching tiles in one row of the map
+ */
+struct TileRun {
+	GlobalCoord global_x;       // Row (global X coordinate)
+	GlobalCoord global_y_begin; // First global Y coordinate of the run
+	GlobalCoord global_y_end;   // One past the last global Y coordinate
+};
+
+/**
+ * @brief Summary of a single connected component
+ */
+struct TileComponent {
+	std::uint32_t size;     // Number of tiles in the component
+	bool touches_boundary;  // True if any tile lies on the map boundary
+	std::uint32_t run_offset; // Index of the first run in
+	                          // ComponentLabels::runs
+	std::uint32_t run_count;  // Number of runs of this component
+};
+
+/**
+ * @brief Result of connected component labeling
+ *
+ * Components are ordered by their first tile in row-major (global X, then
+ * global Y) order, which makes the result independent of the stripe count.
+ */
+struct ComponentLabels {
+	std::vector<TileComponent> components;
+	std::vector<TileRun> runs; // Runs grouped by component
+
+	/**
+	 * @brief Get the runs that make up a component
+	 * @param component A component of this labeling
+	 */
+	std::span<const TileRun> runs_of(const TileComponent &component) const {
+		return {runs.data() + component.run_offset, component.run_count};
+	}
+
+	/**
+	 * @brief Expand a component into its tile positions
+	 * @param component A component of this labeling
+	 * @return Positions of all tiles in the component, in row-major order
+	 */
+	std::vector<TilePos> tiles_of(const TileComponent &component) const;
+};
+
+/**
+ * @brief Label connected components of the tiles selected by a mask
+ *
+ * Uses a scanline algorithm: tiles are grouped into horizontal runs, runs on
+ * adjacent rows are merged with union-find, and each component is reported
+ * with its size, boundary contact and runs in a single sweep. The map is split
+ * into one row stripe per pool thread; the stripes are scanned in parallel on
+ * the pool, then merged at the stripe borders.
+ *
+ * @param tilemap The tilemap to label
+ * @param mask Mask selecting the tiles that belong to components
+ * @param chebyshev If true, use 8-connectivity, otherwise 4-connectivity
+ * @param pool Worker pool to scan the row stripes on
+ */
+ComponentLabels label_components(
+	const TileMap &tilemap, const TileMask &mask, bool chebyshev,
+	WorkerPool &pool
+);
+
+/**
+ * @brief Label connected components of the tiles selected by a mask on the
+ * calling thread
+ * @param tilemap The tilemap to label
+ * @param mask Mask selecting the tiles that belong to components
+ * @param chebyshev If true, use 8-connectivity, otherwise 4-connectivity
+ */
+ComponentLabels label_components(
+	const TileMap &tilemap, const TileMask &mask, bool chebyshev
+);
+
+/**
+ * @brief Label connected components of the tiles matching a predicate
+ * @param tilemap The tilemap to label
+ * @param pred Predicate taking a Tile and returning bool
+ * @param chebyshev If true, use 8-connectivity, otherwise 4-connectivity
+ * @param pool Worker pool to scan the row stripes on
+ */
+template<typename Pred>
+ComponentLabels label_components(
+	const TileMap &tilemap, Pred pred, bool chebyshev, WorkerPool &pool
+) {
+	return label_components(tilemap, make_tile_mask(pred), chebyshev, pool);
+}
+
+/**
+ * @brief Label connected components of the tiles matching a predicate on the
+ * calling thread
+ * @param tilemap The tilemap to label
+ * @param pred Predicate taking a Tile and returning bool
+ * @param chebyshev If true, use 8-connectivity, otherwise 4-connectivity
+ */
+template<typename Pred>
+ComponentLabels label_components(
+	const TileMap &tilemap, Pred pred, bool chebyshev
+) {
+	return label_components(tilemap, make_tile_mask(pred), chebyshev);
+}
+
+} // namespace istd
+
+#endif
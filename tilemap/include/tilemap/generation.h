@@ -1,18 +1,30 @@
 #ifndef TILEMAP_GENERATION_H
 #define TILEMAP_GENERATION_H
 
+#include "tilemap/noise.h"
+#include "tilemap/pipeline.h"
 #include "tilemap/tilemap.h"
+#include "tilemap/worker_pool.h"
 #include "tilemap/xoroshiro.h"
 #include <cstdint>
 
 namespace istd {
 
+// Version of the generator output, part of generation cache keys. Bump it
+// whenever a change makes some pass produce a different map for the same seed
+// and configuration.
+constexpr std::uint32_t generator_version = 1;
+
 /**
  * @brief Configuration parameters for terrain generation
  */
 struct GenerationConfig {
 	Seed seed;
 
+	// Number of threads used by parallel passes (1 = single-threaded). The
+	// generated map does not depend on this value.
+	std::uint32_t threads = 1;
+
 	// Noise parameters
 	double temperature_scale = 0.05; // Scale for temperature noise
 	int temperature_octaves = 3;     // Number of octaves for temperature noise
@@ -26,6 +38,14 @@ struct GenerationConfig {
 	int base_octaves = 3;            // Number of octaves for base terrain noise
 	double base_persistence = 0.5;   // Persistence for base terrain noise
 
+	// Resolution of the quantile lookup tables that map Perlin noise to a
+	// uniform distribution; more buckets trade cache footprint for accuracy
+	std::uint32_t noise_quantile_buckets = 1024;
+
+	// Hash behind the per-tile random decisions of the smoothing and resource
+	// passes; MultiplyXorshift is cheaper but yields different maps
+	NoiseBackend noise_backend = NoiseBackend::Permutation;
+
 	int mountain_smoothen_steps = 2; // Number of steps for mountain smoothing
 	                                 // cellular automata
 	std::uint32_t mountain_remove_threshold = 10; // Threshold for mountain
@@ -67,11 +87,22 @@ struct GenerationConfig {
 	                                         // growth per neighbor (n / 255)
 };
 
+/**
+ * @brief Build the standard generation pipeline
+ *
+ * Passes, in order: biome, base_tile_type, smoothen_mountains,
+ * smoothen_islands, mountain_hole_fill, deepwater, oil, mineral_cluster, coal.
+ */
+GenerationPipeline default_pipeline();
+
 // Terrain generator class that manages the generation process
 class TerrainGenerator {
 private:
 	const GenerationConfig &config_;
-	Xoroshiro128PP master_rng_;
+	WorkerPool pool_;
+	GenerationPipeline pipeline_;
+	PipelineReport report_;
+	PassSnapshotCache *snapshots_ = nullptr;
 
 public:
 	/**
@@ -86,61 +117,33 @@ public:
 	 */
 	void operator()(TileMap &tilemap);
 
-private:
-	/**
-	 * @brief Generate biome data for all chunks
-	 * @param tilemap The tilemap to generate biomes into
-	 */
-	void biome_pass(TileMap &tilemap);
-
-	/**
-	 * @brief Generate base tile types for all chunks
-	 * @param tilemap The tilemap to generate base types into
-	 */
-	void base_tile_type_pass(TileMap &tilemap);
-
 	/**
-	 * @brief Smoothen mountains in the terrain
-	 * @param tilemap The tilemap to process
+	 * @brief Get the pipeline run by operator(), initially default_pipeline()
 	 */
-	void smoothen_mountains_pass(TileMap &tilemap);
+	GenerationPipeline &pipeline() noexcept {
+		return pipeline_;
+	}
 
 	/**
-	 * @brief Smoothen islands in the terrain
-	 * @param tilemap The tilemap to process
+	 * @brief Keep per-pass snapshots for incremental regeneration
+	 *
+	 * With a cache set, calling operator() again after changing a config field
+	 * only reruns the passes that read it and the passes after them. The
+	 * config is held by reference, so it can be edited between calls.
+	 * @param snapshots Snapshot cache, or nullptr to always run every pass
 	 */
-	void smoothen_islands_pass(TileMap &tilemap);
+	void set_snapshot_cache(PassSnapshotCache *snapshots) noexcept {
+		snapshots_ = snapshots;
+	}
 
 	/**
-	 * @brief Fill small holes in the terrain
-	 * @param tilemap The tilemap to process
+	 * @brief Get the per-pass measurements of the last operator() call
 	 */
-	void mountain_hole_fill_pass(TileMap &tilemap);
-
-	/**
-	 * @brief Generate deepwater tiles in ocean biomes
-	 * @param tilemap The tilemap to process
-	 */
-	void deepwater_pass(TileMap &tilemap);
-
-	/**
-	 * @brief Generate oil clusters on suitable terrain
-	 * @param tilemap The tilemap to process
-	 */
-	void oil_pass(TileMap &tilemap);
-
-	/**
-	 * @brief Generate mineral clusters on suitable terrain
-	 * @param tilemap The tilemap to process
-	 */
-	void mineral_cluster_pass(TileMap &tilemap);
-
-	/**
-	 * @brief Generate coal deposits on suitable terrain
-	 * @param tilemap The tilemap to process
-	 */
-	void coal_pass(TileMap &tilemap);
+	const PipelineReport &report() const noexcept {
+		return report_;
+	}
 };
+
 /**
  * @brief Generate a tilemap using the new biome-based system
  * @param tilemap The tilemap to generate into
@@ -0,0 +1,82 @@
+#ifndef ISTD_TILEMAP_GENERATION_CACHE_H
+#define ISTD_TILEMAP_GENERATION_CACHE_H
+
+#include "tilemap/generation.h"
+#include "tilemap/tilemap.h"
+#include <cstdint>
+#include <filesystem>
+
+namespace istd {
+
+/**
+ * @brief Directory of generated tilemaps, keyed by seed and configuration
+ *
+ * Each entry is a tilemap file (see map_file.h) named after its key, with the
+ * key stored as its user key. Entries are written to a temporary file and
+ * renamed into place, so a crash during store() never leaves a truncated
+ * entry behind, and corrupt entries fail their chunk checksums and count as
+ * misses.
+ */
+class GenerationCache {
+private:
+	std::filesystem::path directory_;
+
+	std::filesystem::path entry_path(std::uint64_t key) const;
+
+public:
+	/**
+	 * @brief Open a cache directory, creating it if needed
+	 * @param directory Directory holding the cache entries
+	 * @throws std::filesystem::filesystem_error if it cannot be created
+	 */
+	explicit GenerationCache(std::filesystem::path directory);
+
+	/**
+	 * @brief Compute the cache key of a generation
+	 *
+	 * Covers generator_version, the seed, the map size and origin and every
+	 * configuration field read by the passes of default_pipeline(), but not
+	 * GenerationConfig::threads, which never changes the output.
+	 * @param config Generation configuration
+	 * @param map_size Number of chunks per side
+	 * @param origin_x World X coordinate of the map, see TileMap::set_origin()
+	 * @param origin_y World Y coordinate of the map
+	 */
+	static std::uint64_t key(
+		const GenerationConfig &config, ChunkCoord map_size,
+		ChunkCoord origin_x = 0, ChunkCoord origin_y = 0
+	);
+
+	/**
+	 * @brief Load a cached map
+	 * @param key Cache key, see key()
+	 * @param tilemap The tilemap to load into, its size must match the entry
+	 * @return True on a hit; false if there is no valid entry, in which case
+	 * the tilemap contents are unspecified
+	 */
+	bool load(std::uint64_t key, TileMap &tilemap) const;
+
+	/**
+	 * @brief Store a generated map
+	 * @param key Cache key, see key()
+	 * @param tilemap The generated tilemap
+	 * @return True if the entry was written
+	 */
+	bool store(std::uint64_t key, const TileMap &tilemap) const;
+};
+
+/**
+ * @brief Load a tilemap from the cache, or generate and cache it on a miss
+ * @param tilemap The tilemap to generate into
+ * @param config Configuration for generation
+ * @param cache Cache to look up and fill
+ * @return True if the map was loaded from the cache
+ */
+bool map_generate(
+	TileMap &tilemap, const GenerationConfig &config,
+	const GenerationCache &cache
+);
+
+} // namespace istd
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef ISTD_TILEMAP_LAZY_TILEMAP_H
+#define ISTD_TILEMAP_LAZY_TILEMAP_H
+
+#include "tilemap/chunk.h"
+#include "tilemap/generation.h"
+#include "tilemap/pipeline.h"
+#include "tilemap/tilemap.h"
+#include "tilemap/worker_pool.h"
+#include <cstdint>
+
+namespace istd {
+
+/**
+ * @brief Tilemap whose chunks are generated when first accessed
+ *
+ * The map is split into square regions of region_size() chunks. The first
+ * access to a chunk generates its whole region: the pipeline runs on a window
+ * holding the region and halo() chunks around it (shifted inwards at the map
+ * border), and only the region is kept. Passes sample their noise at world
+ * coordinates and treat the window border like the map border, so
+ * - a region only depends on the seed, the configuration and its place, not
+ *   on the order in which chunks are requested;
+ * - effects reaching less than the halo, such as cellular automaton smoothing
+ *   or the removal of small islands and holes, match across region borders
+ *   and match map_generate();
+ * - resource clusters are sampled per window, so they differ from
+ *   map_generate() and may be cut off at region borders.
+ *
+ * Generating an area costs about ((region_size + 2 * halo) / region_size)^2
+ * times as much as generating it with map_generate(), but only the explored
+ * area is ever generated. Not thread-safe.
+ */
+class LazyTileMap {
+private:
+	GenerationConfig config_;
+	WorkerPool pool_;
+	GenerationPipeline pipeline_;
+	PipelineReport report_;
+	TileMap tilemap_; // On demand, chunks are allocated with their region
+	ChunkCoord region_size_;
+	ChunkCoord halo_;
+	std::size_t generated_regions_ = 0;
+
+	// Regions are generated whole, so their first chunk is allocated iff
+	// the region is generated
+	bool is_region_generated(ChunkCoord chunk_x, ChunkCoord chunk_y) const {
+		return tilemap_.has_chunk(
+			chunk_x - chunk_x % region_size_, chunk_y - chunk_y % region_size_
+		);
+	}
+
+	void generate_region(ChunkCoord chunk_x, ChunkCoord chunk_y);
+
+public:
+	/**
+	 * @brief Construct a map without generating anything
+	 * @param size Number of chunks in each dimension (1 to TileMap::max_size)
+	 * @param config Generation configuration, copied
+	 * @param region_size Number of chunks per side of a region
+	 * @param halo Number of chunks generated around a region as context
+	 * @throws std::invalid_argument if size or region_size is 0
+	 */
+	LazyTileMap(
+		ChunkCoord size, const GenerationConfig &config,
+		ChunkCoord region_size = 4, ChunkCoord halo = 1
+	);
+
+	ChunkCoord get_size() const noexcept {
+		return tilemap_.get_size();
+	}
+
+	ChunkCoord region_size() const noexcept {
+		return region_size_;
+	}
+
+	ChunkCoord halo() const noexcept {
+		return halo_;
+	}
+
+	/**
+	 * @brief Get the pipeline run on every window, initially
+	 * default_pipeline()
+	 * @note Changing it after chunks were generated leaves seams at the
+	 * borders of the regions generated before
+	 */
+	GenerationPipeline &pipeline() noexcept {
+		return pipeline_;
+	}
+
+	/**
+	 * @brief Get the per-pass measurements of the last generated region
+	 */
+	const PipelineReport &report() const noexcept {
+		return report_;
+	}
+
+	/**
+	 * @brief Get the number of regions generated so far
+	 */
+	std::size_t generated_region_count() const noexcept {
+		return generated_regions_;
+	}
+
+	/**
+	 * @brief Check if a chunk has been generated
+	 * @throws std::out_of_range if the coordinates are outside the map
+	 */
+	bool is_generated(ChunkCoord chunk_x, ChunkCoord chunk_y) const;
+
+	/**
+	 * @brief Get a chunk, generating its region first if needed
+	 * @throws std::out_of_range if the coordinates are outside the map
+	 */
+	Chunk &get_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y);
+
+	/**
+	 * @brief Get a tile, generating its region first if needed
+	 * @throws std::out_of_range if the position is outside the map
+	 */
+	Tile &get_tile(TilePos pos);
+
+	/**
+	 * @brief Set a tile, generating its region first if needed
+	 * @throws std::out_of_range if the position is outside the map
+	 */
+	void set_tile(TilePos pos, const Tile &tile);
+
+	/**
+	 * @brief Generate every chunk in a rectangle ahead of use
+	 * @param chunk_x First chunk X coordinate
+	 * @param chunk_y First chunk Y coordinate
+	 * @param width Number of chunks along X, clipped to the map
+	 * @param height Number of chunks along Y, clipped to the map
+	 * @throws std::out_of_range if the first chunk is outside the map
+	 */
+	void generate_area(
+		ChunkCoord chunk_x, ChunkCoord chunk_y, ChunkCoord width,
+		ChunkCoord height
+	);
+
+	/**
+	 * @brief Get the underlying map
+	 *
+	 * Chunks that were not generated yet read as default tiles and biomes,
+	 * see TileMap::has_chunk().
+	 */
+	const TileMap &tilemap() const noexcept {
+		return tilemap_;
+	}
+};
+
+} // namespace istd
+
+#endif
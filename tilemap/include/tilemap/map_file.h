@@ -0,0 +1,297 @@
+#ifndef ISTD_TILEMAP_MAP_FILE_H
+#define ISTD_TILEMAP_MAP_FILE_H
+
+#include "tilemap/chunk.h"
+#include "tilemap/compact_chunk.h"
+#include "tilemap/mapped_file.h"
+#include "tilemap/tilemap.h"
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+namespace istd {
+
+/**
+ * @brief Layout of the binary tilemap file format
+ *
+ * All integers are little-endian.
+ *
+ * Header (48 bytes):
+ *   magic "ISTDTMAP", u32 version, u32 tiles per chunk side (64),
+ *   u32 chunks per map side, u32 chunk count, u64 user key,
+ *   u64 offset of the chunk index, u64 offset of the first chunk record
+ *
+ * Chunk index: one entry per chunk, ordered chunk_x * size + chunk_y:
+ *   u64 record offset (0 if the chunk was not written), u32 record size,
+ *   u32 CRC-32 of the record, u8 encoding, 7 reserved bytes
+ *
+ * Chunk record, encoding 0 (raw): the 64x64 tiles row by row as
+ * (base | surface << 4), then the 16x16 sub-chunk biomes. This is the memory
+ * layout of Chunk, so a file whose raw records are stored back to back in
+ * index order can be memory-mapped as a TileMap (see map_tilemap()).
+ *
+ * Chunk record, encoding 1 (palette): u8 palette size n (1 to 16), the n
+ * palette tiles, the tile indices bit-packed as in CompactChunk in u64 words,
+ * then the 16x16 sub-chunk biomes. A uniform chunk takes 258 bytes.
+ */
+namespace map_file {
+
+constexpr std::array<char, 8> magic = {'I', 'S', 'T', 'D', 'T', 'M', 'A', 'P'};
+constexpr std::uint32_t version = 2;
+constexpr std::size_t header_size = 48;
+constexpr std::size_t index_entry_size = 24;
+
+enum class ChunkEncoding : std::uint8_t {
+	Raw = 0,
+	Palette = 1,
+};
+
+constexpr std::size_t raw_record_size = Chunk::size * Chunk::size
+	+ Chunk::subchunk_count * Chunk::subchunk_count;
+constexpr std::size_t max_record_size = raw_record_size;
+
+struct IndexEntry {
+	std::uint64_t offset = 0;
+	std::uint32_t size = 0;
+	std::uint32_t checksum = 0;
+	ChunkEncoding encoding = ChunkEncoding::Raw;
+};
+
+/**
+ * @brief Compute the CRC-32 (IEEE 802.3) of a byte sequence
+ */
+std::uint32_t crc32(std::span<const std::uint8_t> data) noexcept;
+
+} // namespace map_file
+
+/**
+ * @brief Streaming writer of the binary tilemap format
+ *
+ * Chunks can be written in any order and each is written to disk right away;
+ * only the index is kept in memory until finish().
+ */
+class TileMapWriter {
+private:
+	std::ofstream file_;
+	ChunkCoord map_size_;
+	std::uint64_t next_offset_;
+	std::vector<map_file::IndexEntry> index_;
+	std::array<std::uint8_t, map_file::max_record_size> record_;
+	bool finished_ = false;
+
+	void append_record(
+		ChunkCoord chunk_x, ChunkCoord chunk_y, std::size_t size,
+		map_file::ChunkEncoding encoding
+	);
+
+public:
+	/**
+	 * @brief Create a tilemap file, replacing any existing file
+	 * @param path Path of the file
+	 * @param map_size Number of chunks per side
+	 * @param user_key Application-defined identifier stored in the header
+	 * @throws std::runtime_error if the file cannot be written
+	 */
+	TileMapWriter(
+		const std::filesystem::path &path, ChunkCoord map_size,
+		std::uint64_t user_key = 0
+	);
+
+	/**
+	 * @brief Append a chunk
+	 * @param chunk_x X coordinate of the chunk
+	 * @param chunk_y Y coordinate of the chunk
+	 * @param chunk The chunk data
+	 * @throws std::out_of_range if the coordinates are outside the map
+	 * @throws std::logic_error if the chunk was already written or the writer
+	 * is finished
+	 * @throws std::runtime_error on a write error
+	 */
+	void write_chunk(
+		ChunkCoord chunk_x, ChunkCoord chunk_y, const Chunk &chunk
+	);
+
+	/**
+	 * @brief Append a compact chunk, as a palette record unless it is
+	 * expanded
+	 * @throws as write_chunk(ChunkCoord, ChunkCoord, const Chunk &)
+	 */
+	void write_chunk(
+		ChunkCoord chunk_x, ChunkCoord chunk_y, const CompactChunk &chunk
+	);
+
+	/**
+	 * @brief Write the chunk index and flush the file
+	 *
+	 * Must be called once all chunks are written; without it the file reads
+	 * as having no chunks.
+	 * @throws std::runtime_error on a write error
+	 */
+	void finish();
+};
+
+/**
+ * @brief Reader of the binary tilemap format with random chunk access
+ *
+ * Only the header and the chunk index are read on open. Every chunk is read
+ * on request and verified against its checksum.
+ */
+class TileMapReader {
+private:
+	std::ifstream file_;
+	ChunkCoord map_size_;
+	std::uint64_t user_key_;
+	std::uint64_t data_offset_;
+	std::vector<map_file::IndexEntry> index_;
+	std::array<std::uint8_t, map_file::max_record_size> record_;
+
+	const map_file::IndexEntry &entry(
+		ChunkCoord chunk_x, ChunkCoord chunk_y
+	) const;
+	const map_file::IndexEntry &read_record(
+		ChunkCoord chunk_x, ChunkCoord chunk_y
+	);
+
+public:
+	/**
+	 * @brief Open a tilemap file and read its index
+	 * @param path Path of the file
+	 * @throws std::runtime_error if the file cannot be read or is not a valid
+	 * tilemap file of a supported version
+	 */
+	explicit TileMapReader(const std::filesystem::path &path);
+
+	/**
+	 * @brief Get the number of chunks per side of the stored map
+	 */
+	ChunkCoord map_size() const noexcept {
+		return map_size_;
+	}
+
+	/**
+	 * @brief Get the application-defined identifier from the header
+	 */
+	std::uint64_t user_key() const noexcept {
+		return user_key_;
+	}
+
+	/**
+	 * @brief Get the offset of the first chunk record
+	 */
+	std::uint64_t data_offset() const noexcept {
+		return data_offset_;
+	}
+
+	/**
+	 * @brief Check if all chunks are raw records stored back to back in index
+	 * order from data_offset(), which is what map_tilemap() requires
+	 */
+	bool is_contiguous() const noexcept;
+
+	/**
+	 * @brief Check if a chunk is stored in the file
+	 * @throws std::out_of_range if the coordinates are outside the map
+	 */
+	bool has_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y) const;
+
+	/**
+	 * @brief Read a single chunk
+	 * @param chunk_x X coordinate of the chunk
+	 * @param chunk_y Y coordinate of the chunk
+	 * @param chunk Chunk to read into
+	 * @throws std::out_of_range if the coordinates are outside the map
+	 * @throws std::runtime_error if the chunk is missing, cannot be read or
+	 * fails its checksum
+	 */
+	void read_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y, Chunk &chunk);
+
+	/**
+	 * @brief Read a single chunk without expanding palette records
+	 * @throws as read_chunk(ChunkCoord, ChunkCoord, Chunk &)
+	 */
+	void read_chunk(
+		ChunkCoord chunk_x, ChunkCoord chunk_y, CompactChunk &chunk
+	);
+
+	/**
+	 * @brief Read every chunk into a tilemap of the same size
+	 *
+	 * A contiguous file (see is_contiguous()) is read into the chunk array
+	 * of an eager tilemap with a single read.
+	 * @throws std::invalid_argument if the tilemap size does not match
+	 * @throws std::runtime_error as read_chunk()
+	 */
+	void read_all(TileMap &tilemap);
+};
+
+/**
+ * @brief Write a whole tilemap to a file
+ * @param path Path of the file
+ * @param tilemap The tilemap to save
+ * @param user_key Application-defined identifier stored in the header
+ * @throws std::runtime_error on a write error
+ */
+void save_tilemap(
+	const std::filesystem::path &path, const TileMap &tilemap,
+	std::uint64_t user_key = 0
+);
+
+/**
+ * @brief Write a whole compact tilemap to a file with palette records
+ *
+ * Much smaller than a raw file for mostly uniform maps, but it cannot be
+ * memory-mapped.
+ * @throws std::runtime_error on a write error
+ */
+void save_tilemap(
+	const std::filesystem::path &path, const CompactTileMap &tilemap,
+	std::uint64_t user_key = 0
+);
+
+/**
+ * @brief Read a whole tilemap from a file
+ * @param path Path of the file
+ * @throws std::runtime_error if the file is invalid or a chunk is missing or
+ * corrupt
+ */
+TileMap load_tilemap(const std::filesystem::path &path);
+
+/**
+ * @brief Read a whole tilemap from a file as a CompactTileMap
+ *
+ * Raw records are compressed on load.
+ * @throws as load_tilemap()
+ */
+CompactTileMap load_compact_tilemap(const std::filesystem::path &path);
+
+/**
+ * @brief Map a tilemap file into memory instead of reading it
+ *
+ * Chunks are paged in by the operating system on first touch, and processes
+ * mapping the same file share its unmodified pages. Checksums are not
+ * verified unless requested, since that would touch every chunk.
+ * @param path Path of a file written by save_tilemap()
+ * @param mode Whether writes through the TileMap stay private or go to the
+ * file; after writing through, call sync_tilemap() to update the checksums
+ * @param verify If true, verify all chunk checksums before returning
+ * @throws std::runtime_error if the file is invalid, not contiguous (see
+ * TileMapReader::is_contiguous()) or cannot be mapped
+ */
+TileMap map_tilemap(
+	const std::filesystem::path &path, MapMode mode, bool verify = false
+);
+
+/**
+ * @brief Recompute the chunk checksums of a write-through mapped tilemap and
+ * write all changes back to its file
+ * @throws std::logic_error if the tilemap is not mapped write-through
+ * @throws std::runtime_error if writing fails
+ */
+void sync_tilemap(TileMap &tilemap);
+
+} // namespace istd
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef ISTD_TILEMAP_MAPPED_FILE_H
+#define ISTD_TILEMAP_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace istd {
+
+/**
+ * @brief How writes to a memory-mapped file are handled
+ */
+enum class MapMode : std::uint8_t {
+	// Writes stay private to the process; unmodified pages remain shared with
+	// every other process mapping the same file through the page cache
+	CopyOnWrite,
+	// Writes go to the file and are visible to other processes mapping it
+	WriteThrough,
+};
+
+/**
+ * @brief Memory mapping of a whole file
+ *
+ * Pages are loaded by the operating system on first touch. Only supported on
+ * POSIX systems.
+ */
+class MappedFile {
+private:
+	std::uint8_t *data_ = nullptr;
+	std::size_t size_ = 0;
+	MapMode mode_;
+
+public:
+	/**
+	 * @brief Map a file into memory, readable and writable
+	 * @param path Path of the file
+	 * @param mode Whether writes are private or go to the file
+	 * @throws std::runtime_error if the file cannot be mapped
+	 */
+	MappedFile(const std::filesystem::path &path, MapMode mode);
+
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	std::span<std::uint8_t> bytes() noexcept {
+		return {data_, size_};
+	}
+
+	std::span<const std::uint8_t> bytes() const noexcept {
+		return {data_, size_};
+	}
+
+	MapMode mode() const noexcept {
+		return mode_;
+	}
+
+	/**
+	 * @brief Write modified pages back to the file and wait for completion
+	 * @throws std::logic_error if the mapping is copy-on-write
+	 * @throws std::runtime_error if writing fails
+	 */
+	void sync();
+};
+
+} // namespace istd
+
+#endif
@@ -29,27 +29,22 @@ public:
 	void operator()(TileMap &tilemap);
 
 	/**
-	 * @brief Generate terrain for a single chunk
-	 * @param tilemap The tilemap to modify
-	 * @param chunk_x Chunk X coordinate
-	 * @param chunk_y Chunk Y coordinate
+	 * @brief Generate base tile types for the entire tilemap, one job per
+	 * chunk
+	 * @param tilemap The tilemap to generate base types into
+	 * @param pool Worker pool to run the chunk jobs on
 	 */
-	void generate_chunk(
-		TileMap &tilemap, std::uint8_t chunk_x, std::uint8_t chunk_y
-	);
+	void operator()(TileMap &tilemap, WorkerPool &pool);
 
 	/**
-	 * @brief Generate terrain for a sub-chunk with specific biome
+	 * @brief Generate terrain for a single chunk, one row of tiles at a time
 	 * @param tilemap The tilemap to modify
 	 * @param chunk_x Chunk X coordinate
 	 * @param chunk_y Chunk Y coordinate
-	 * @param sub_pos Sub-chunk position within the chunk
-	 * @param biome The biome type for this sub-chunk
 	 */
-	void generate_subchunk(
-		TileMap &tilemap, std::uint8_t chunk_x, std::uint8_t chunk_y,
-		SubChunkPos sub_pos, BiomeType biome
-	);
+	void generate_chunk(
+		TileMap &tilemap, ChunkCoord chunk_x, ChunkCoord chunk_y
+	) const;
 
 	/**
 	 * @brief Determine base terrain type based on noise value and biome
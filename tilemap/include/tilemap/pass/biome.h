@@ -3,6 +3,7 @@
 
 #include "tilemap/generation.h"
 #include "tilemap/noise.h"
+#include <span>
 
 namespace istd {
 
@@ -30,15 +31,34 @@ public:
 	 */
 	void operator()(TileMap &tilemap);
 
+	/**
+	 * @brief Generate biomes for the entire tilemap, one job per chunk
+	 * @param tilemap The tilemap to generate biomes into
+	 * @param pool Worker pool to run the chunk jobs on
+	 */
+	void operator()(TileMap &tilemap, WorkerPool &pool);
+
+	/**
+	 * @brief Generate biomes for a single chunk
+	 * @param tilemap The tilemap to modify
+	 * @param chunk_x Chunk X coordinate
+	 * @param chunk_y Chunk Y coordinate
+	 */
+	void generate_chunk(
+		TileMap &tilemap, ChunkCoord chunk_x, ChunkCoord chunk_y
+	) const;
+
 private:
 	/**
-	 * @brief Get climate values at a global position
-	 * @param global_x Global X coordinate
-	 * @param global_y Global Y coordinate
-	 * @return Pair of (temperature, humidity) in range [0,1]
+	 * @brief Get climate values for a row of global positions
+	 * @param global_x Global X coordinate shared by the row
+	 * @param global_ys Global Y coordinates
+	 * @param temperature Output temperatures in range [0,1]
+	 * @param humidity Output humidities in range [0,1]
 	 */
-	std::pair<double, double> get_climate(
-		double global_x, double global_y
+	void get_climate_row(
+		double global_x, std::span<const double> global_ys,
+		std::span<double> temperature, std::span<double> humidity
 	) const;
 };
 
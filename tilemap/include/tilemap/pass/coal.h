@@ -42,26 +42,43 @@ private:
 	 * @param seeds Output vector to fill with seed positions
 	 */
 	void chunk_coal_seeds(
-		const TileMap &tilemap, std::uint8_t chunk_x, std::uint8_t chunk_y,
+		const TileMap &tilemap, ChunkCoord chunk_x, ChunkCoord chunk_y,
 		std::vector<TilePos> &seeds
 	);
 
 	/**
 	 * @brief Evolve coal deposits using cellular automata
+	 *
+	 * Only suitable tiles with at least one coal neighbor can change, so each
+	 * step visits an active frontier of such tiles and keeps a cached coal
+	 * neighbor count per tile instead of rescanning the whole map.
 	 * @param tilemap The tilemap to modify
 	 * @param initial_seeds Initial coal seed positions
 	 */
 	void evolve_coal_deposits(
 		TileMap &tilemap, const std::vector<TilePos> &initial_seeds
-	);
+	) const;
+
+	/**
+	 * @brief Decide whether coal grows on a suitable tile in a step
+	 * @param tilemap The tilemap, only used to look up biomes
+	 * @param pos Position of the tile
+	 * @param coal_neighbors Number of coal tiles among its 4 neighbors
+	 * @param noise_value Noise of the tile for this step, i.e.
+	 * noise(global_x, global_y, step)
+	 * @return True if the tile turns into coal
+	 */
+	bool should_grow_coal(
+		const TileMap &tilemap, TilePos pos, std::uint8_t coal_neighbors,
+		std::uint64_t noise_value
+	) const;
 
 	/**
 	 * @brief Check if a tile is suitable for coal placement
-	 * @param tilemap The tilemap to check
-	 * @param pos Position to check
-	 * @return True if coal can be placed at this position
+	 * @param tile The tile to check
+	 * @return True if coal can be placed on this tile
 	 */
-	bool is_suitable_for_coal(const TileMap &tilemap, TilePos pos) const;
+	bool is_suitable_for_coal(Tile tile) const;
 
 	/**
 	 * @brief Get the coal growth probability for a specific biome
@@ -69,16 +86,6 @@ private:
 	 * @return Growth probability multiplier (x / 255)
 	 */
 	std::uint8_t get_biome_coal_growth_probability(BiomeType biome) const;
-
-	/**
-	 * @brief Count coal neighbors around a position
-	 * @param tilemap The tilemap to check
-	 * @param pos Position to check around
-	 * @return Number of coal neighbors
-	 */
-	std::uint8_t count_coal_neighbors(
-		const TileMap &tilemap, TilePos pos
-	) const;
 };
 
 } // namespace istd
@@ -3,6 +3,7 @@
 
 #include "tilemap/tilemap.h"
 #include <cstdint>
+#include <vector>
 
 namespace istd {
 
@@ -24,40 +25,37 @@ public:
 	 */
 	void operator()(TileMap &tilemap);
 
-private:
 	/**
-	 * @brief Check if a tile position is within a certain radius and all tiles
-	 * are water
-	 * @param tilemap The tilemap to check
-	 * @param center_pos Center position to check around
-	 * @param radius Radius to check within
-	 * @return True if all tiles within radius are water
+	 * @brief Compute the Chebyshev distance from every tile to the nearest
+	 * tile that is neither water nor deepwater
+	 *
+	 * Uses a two-sweep chamfer transform with unit weights, which is exact for
+	 * the Chebyshev metric and runs in O(tiles) regardless of the radius. Tiles
+	 * outside the map count as water.
+	 * @param tilemap The tilemap to measure
+	 * @param cap Distances are saturated at this value, must be below
+	 * UINT16_MAX
+	 * @return Row-major distance field, indexed global_x * width + global_y
 	 */
+	static std::vector<std::uint16_t> distance_to_land(
+		const TileMap &tilemap, std::uint16_t cap
+	);
 
 private:
 	/**
 	 * @brief Process an ocean sub-chunk to generate deepwater tiles
 	 * @param tilemap The tilemap to process
+	 * @param distance Distance field from distance_to_land()
+	 * @param radius Deepwater radius, clamped to the map width
 	 * @param chunk_x Chunk X coordinate
 	 * @param chunk_y Chunk Y coordinate
 	 * @param sub_pos Sub-chunk position within the chunk
 	 */
 	void process_ocean_subchunk(
-		TileMap &tilemap, std::uint8_t chunk_x, std::uint8_t chunk_y,
+		TileMap &tilemap, const std::vector<std::uint16_t> &distance,
+		std::uint32_t radius, ChunkCoord chunk_x, ChunkCoord chunk_y,
 		SubChunkPos sub_pos
 	);
-
-	/**
-	 * @brief Check if a tile position is within a certain radius and all tiles
-	 * are water or deepwater
-	 * @param tilemap The tilemap to check
-	 * @param center_pos Center position to check around
-	 * @param radius Radius to check within
-	 * @return True if all tiles within radius are water or deepwater
-	 */
-	bool is_surrounded_by_water(
-		const TileMap &tilemap, TilePos center_pos, std::uint32_t radius
-	) const;
 };
 
 } // namespace istd
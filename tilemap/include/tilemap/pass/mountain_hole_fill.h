@@ -17,11 +17,20 @@ public:
 	explicit MountainHoleFillPass(const GenerationConfig &config);
 
 	/**
-	 * @brief Fill small holes in the terrain using BFS
+	 * @brief Fill small holes in the terrain using connected component
+	 * labeling
 	 * @param tilemap The tilemap to process
 	 */
 	void operator()(TileMap &tilemap);
 
+	/**
+	 * @brief Fill small holes in the terrain, labeling the components on a
+	 * worker pool
+	 * @param tilemap The tilemap to process
+	 * @param pool Worker pool to label the components on
+	 */
+	void operator()(TileMap &tilemap, WorkerPool &pool);
+
 private:
 	/**
 	 * @brief Check if a tile type is passable for BFS
@@ -29,19 +38,6 @@ private:
 	 * @return True if the tile is passable (not mountain or at boundary)
 	 */
 	bool is_passable(BaseTileType type) const;
-
-	/**
-	 * @brief Perform BFS to find connected component size
-	 * @param tilemap The tilemap to search
-	 * @param start_pos Starting position for BFS
-	 * @param visited 2D array tracking visited tiles
-	 * @param positions Output vector of positions in this component
-	 * @return Size of the connected component
-	 */
-	std::uint32_t bfs_component_size(
-		TileMap &tilemap, TilePos start_pos,
-		std::vector<std::vector<bool>> &visited, std::vector<TilePos> &positions
-	);
 };
 
 } // namespace istd
@@ -1,6 +1,7 @@
 #ifndef ISTD_TILEMAP_PASS_SMOOTHEN_ISLAND_H
 #define ISTD_TILEMAP_PASS_SMOOTHEN_ISLAND_H
 
+#include "tilemap/cellular_automaton.h"
 #include "tilemap/generation.h"
 #include "tilemap/noise.h"
 
@@ -11,36 +12,39 @@ private:
 	const GenerationConfig &config_;
 	DiscreteRandomNoise noise_;
 
-	/**
-	 * @brief Perform BFS to find connected component size for islands
-	 * @param tilemap The tilemap to search
-	 * @param start_pos Starting position for BFS
-	 * @param visited 2D array tracking visited tiles
-	 * @param positions Output vector of positions in this component
-	 * @return Size of the connected component
-	 */
-	std::uint32_t bfs_component_size(
-		TileMap &tilemap, TilePos start_pos,
-		std::vector<std::vector<bool>> &visited, std::vector<TilePos> &positions
-	);
-
 	/**
 	 * @brief Remove small island components to create smoother terrain
 	 * @param tilemap The tilemap to process
+	 * @param pool Worker pool to label the components on
 	 */
-	void remove_small_island(TileMap &tilemap);
+	void remove_small_island(TileMap &tilemap, WorkerPool &pool);
 
 	/**
 	 * @brief Smoothen islands with cellular automata
 	 * @param tilemap The tilemap to process
+	 * @param step_i Index of the automaton step (1-based)
+	 * @param automaton Automaton engine holding the double buffer
+	 * @param pool Worker pool to run the step on
 	 */
-	void smoothen_islands(TileMap &tilemap, std::uint32_t step_i);
+	void smoothen_islands(
+		TileMap &tilemap, std::uint32_t step_i, CellularAutomaton &automaton,
+		WorkerPool &pool
+	) const;
 
-	void smoothen_islands_subchunk(
-		TileMap &tilemap, std::uint8_t chunk_x, std::uint8_t chunk_y,
-		SubChunkPos sub_pos, std::uint32_t step_i,
-		std::vector<std::pair<TilePos, Tile>> &replacements
-	);
+	/**
+	 * @brief Cellular automaton rule for island smoothing
+	 * @param tilemap The tilemap, only used to look up biomes
+	 * @param pos Position of the tile
+	 * @param tile The tile in the previous generation
+	 * @param neighborhood 8-connected neighborhood in the previous generation
+	 * @param noise_value Noise of the tile for this step, i.e.
+	 * noise(global_x, global_y, step_i)
+	 * @return The tile in the next generation
+	 */
+	Tile smoothen_islands_tile(
+		const TileMap &tilemap, TilePos pos, Tile tile,
+		const CANeighborhood<true> &neighborhood, std::uint64_t noise_value
+	) const;
 
 	struct CACtx {
 		BiomeType biome;
@@ -70,6 +74,14 @@ public:
 	 * @param tilemap The tilemap to process
 	 */
 	void operator()(TileMap &tilemap);
+
+	/**
+	 * @brief Smoothen islands in the terrain, running the cellular automaton
+	 * on a worker pool
+	 * @param tilemap The tilemap to process
+	 * @param pool Worker pool to run the automaton steps on
+	 */
+	void operator()(TileMap &tilemap, WorkerPool &pool);
 };
 
 } // namespace istd
@@ -1,6 +1,7 @@
 #ifndef ISTD_TILEMAP_PASS_SMOOTHEN_MOUNTAIN_H
 #define ISTD_TILEMAP_PASS_SMOOTHEN_MOUNTAIN_H
 
+#include "tilemap/cellular_automaton.h"
 #include "tilemap/generation.h"
 #include "tilemap/noise.h"
 
@@ -11,19 +12,6 @@ private:
 	const GenerationConfig &config_;
 	DiscreteRandomNoise noise_;
 
-	/**
-	 * @brief Perform BFS to find connected component size for mountains
-	 * @param tilemap The tilemap to search
-	 * @param start_pos Starting position for BFS
-	 * @param visited 2D array tracking visited tiles
-	 * @param positions Output vector of positions in this component
-	 * @return Size of the connected component
-	 */
-	std::uint32_t bfs_component_size(
-		TileMap &tilemap, TilePos start_pos,
-		std::vector<std::vector<bool>> &visited, std::vector<TilePos> &positions
-	);
-
 	/**
 	 * @brief Replace mountain tiles with terrain types from neighboring areas
 	 * @param tilemap The tilemap to modify
@@ -34,19 +22,35 @@ private:
 	/**
 	 * @brief Remove small mountain components to create smoother terrain
 	 * @param tilemap The tilemap to process
+	 * @param pool Worker pool to label the components on
 	 */
-	void remove_small_mountain(TileMap &tilemap);
+	void remove_small_mountain(TileMap &tilemap, WorkerPool &pool);
 
 	/**
 	 * @brief Smoothen mountains with cellular automata
 	 * @param tilemap The tilemap to process
+	 * @param step_i Index of the automaton step (1-based)
+	 * @param automaton Automaton engine holding the double buffer
+	 * @param pool Worker pool to run the step on
 	 */
-	void smoothen_mountains(TileMap &tilemap, std::uint32_t step_i);
+	void smoothen_mountains(
+		TileMap &tilemap, std::uint32_t step_i, CellularAutomaton &automaton,
+		WorkerPool &pool
+	) const;
 
-	void smoothen_mountains_tile(
-		const TileMap &tilemap, TilePos pos, std::uint32_t step_i,
-		std::vector<std::pair<TilePos, Tile>> &replacements
-	);
+	/**
+	 * @brief Cellular automaton rule for mountain smoothing
+	 * @param tilemap The tilemap, only used for world coordinates
+	 * @param pos Position of the tile
+	 * @param tile The tile in the previous generation
+	 * @param neighborhood 4-connected neighborhood in the previous generation
+	 * @param step_i Index of the automaton step (1-based)
+	 * @return The tile in the next generation
+	 */
+	Tile smoothen_mountains_tile(
+		const TileMap &tilemap, TilePos pos, Tile tile,
+		const CANeighborhood<false> &neighborhood, std::uint32_t step_i
+	) const;
 
 public:
 	/**
@@ -61,6 +65,14 @@ public:
 	 * @param tilemap The tilemap to process
 	 */
 	void operator()(TileMap &tilemap);
+
+	/**
+	 * @brief Smoothen mountains in the terrain, running the cellular automaton
+	 * on a worker pool
+	 * @param tilemap The tilemap to process
+	 * @param pool Worker pool to run the automaton steps on
+	 */
+	void operator()(TileMap &tilemap, WorkerPool &pool);
 };
 
 } // namespace istd
@@ -0,0 +1,279 @@
+#ifndef ISTD_TILEMAP_PIPELINE_H
+#define ISTD_TILEMAP_PIPELINE_H
+
+#include "tilemap/compact_chunk.h"
+#include "tilemap/tilemap.h"
+#include "tilemap/worker_pool.h"
+#include "tilemap/xoroshiro.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace istd {
+
+struct GenerationConfig;
+
+/**
+ * @brief Everything a pass receives from the pipeline besides the map
+ */
+struct PassContext {
+	const GenerationConfig &config;
+	WorkerPool &pool;
+	// RNG streams owned by the pass, as many as it was registered with
+	std::span<const Xoroshiro128PP> rngs;
+};
+
+/**
+ * @brief FNV-1a hash over the bytes of plain values, used for cache keys
+ *
+ * Values are hashed by their object representation, so keys are stable
+ * across runs and builds on the same byte order.
+ */
+class StableHasher {
+private:
+	std::uint64_t state_ = 0xCBF29CE484222325;
+
+	void add_bytes(const void *data, std::size_t size) noexcept {
+		const auto *bytes = static_cast<const unsigned char *>(data);
+		for (std::size_t i = 0; i < size; ++i) {
+			state_ = (state_ ^ bytes[i]) * 0x100000001B3;
+		}
+	}
+
+public:
+	/**
+	 * @brief Hash values without padding bits (integers, enums, floating
+	 * point, Seed)
+	 */
+	template<typename... Ts>
+	requires((
+		std::has_unique_object_representations_v<Ts>
+		|| std::is_floating_point_v<Ts>
+	) && ...)
+	StableHasher &add(const Ts &...values) noexcept {
+		(add_bytes(&values, sizeof(values)), ...);
+		return *this;
+	}
+
+	/**
+	 * @brief Hash a string, including its length
+	 */
+	StableHasher &add(std::string_view text) noexcept {
+		add(text.size());
+		add_bytes(text.data(), text.size());
+		return *this;
+	}
+
+	std::uint64_t value() const noexcept {
+		return state_;
+	}
+};
+
+/**
+ * @brief Heap allocation totals, as returned by an allocation probe
+ */
+struct AllocationStats {
+	std::uint64_t count = 0;
+	std::uint64_t bytes = 0;
+};
+
+/**
+ * @brief Function returning the running allocation totals of the process
+ *
+ * The library does not replace the global allocator; an application that does
+ * (see examples/tilemap_demo.cpp) installs a probe to get per-pass numbers.
+ */
+using AllocationProbe = AllocationStats (*)();
+
+/**
+ * @brief Measurements of a single pass
+ */
+struct PassReport {
+	std::string name;
+	std::chrono::nanoseconds wall_time{0};
+	std::uint64_t tiles_written = 0;  // Tiles the pass changed, if counted
+	std::uint64_t biomes_written = 0; // Sub-chunk biomes changed, if counted
+	AllocationStats allocations;      // Zero without an allocation probe
+	bool restored = false; // Skipped, its output came from a snapshot
+};
+
+/**
+ * @brief Measurements of a pipeline run, one entry per pass in run order
+ */
+struct PipelineReport {
+	std::vector<PassReport> passes;
+	bool allocations_measured = false;
+	bool writes_counted = false;
+
+	/**
+	 * @brief Get the summed wall time of all passes
+	 */
+	std::chrono::nanoseconds total_wall_time() const;
+
+	/**
+	 * @brief Find the report of a pass by name
+	 * @return The report, or nullptr if no pass has that name
+	 */
+	const PassReport *find(std::string_view name) const;
+};
+
+/**
+ * @brief Snapshots of the map after each pass, for incremental regeneration
+ *
+ * Holds the latest snapshot of every pass together with the key of the
+ * inputs it was generated from. Snapshots are stored as CompactTileMaps, so
+ * chunks that are still uniform or use few tiles cost little memory.
+ */
+class PassSnapshotCache {
+private:
+	struct Snapshot {
+		std::uint64_t key;
+		CompactTileMap tilemap;
+	};
+
+	std::map<std::string, Snapshot, std::less<>> snapshots_;
+
+public:
+	/**
+	 * @brief Find the snapshot taken after a pass
+	 * @param pass Name of the pass
+	 * @param key Key of the pass inputs, see GenerationPipeline::stage_keys()
+	 * @return The snapshot, or nullptr if there is none for this key
+	 */
+	const CompactTileMap *find(
+		std::string_view pass, std::uint64_t key
+	) const;
+
+	/**
+	 * @brief Store the snapshot of a pass, replacing the previous one
+	 */
+	void store(
+		std::string_view pass, std::uint64_t key, const TileMap &tilemap
+	);
+
+	/**
+	 * @brief Drop all snapshots
+	 */
+	void clear() noexcept {
+		snapshots_.clear();
+	}
+
+	std::size_t size() const noexcept {
+		return snapshots_.size();
+	}
+};
+
+/**
+ * @brief Ordered list of named generation passes
+ *
+ * Every pass declares how many RNG streams it owns. Streams are handed out in
+ * registration order from the master generator seeded by
+ * GenerationConfig::seed, one jump_96() apart, so adding a pass at the end
+ * never changes the streams of the passes before it.
+ *
+ * Every pass also declares the configuration fields it reads. The key of a
+ * pass covers the seed, the map size and origin and the fields of that pass
+ * and all passes before it, so with a PassSnapshotCache a run restores the map
+ * after the last pass whose inputs did not change and only runs the passes
+ * after it.
+ */
+class GenerationPipeline {
+public:
+	using PassFunction = std::function<void(TileMap &, const PassContext &)>;
+	// Hashes the configuration fields a pass reads
+	using ConfigHashFunction
+		= std::function<void(StableHasher &, const GenerationConfig &)>;
+
+private:
+	struct Stage {
+		std::string name;
+		std::uint32_t rng_streams;
+		PassFunction run;
+		ConfigHashFunction hash_config;
+	};
+
+	std::vector<Stage> stages_;
+	AllocationProbe allocation_probe_ = nullptr;
+	bool count_writes_ = false;
+
+public:
+	/**
+	 * @brief Append a pass to the pipeline
+	 * @param name Unique name of the pass, used in reports
+	 * @param rng_streams Number of RNG streams the pass owns
+	 * @param run Pass body
+	 * @param hash_config Hashes the configuration fields the pass reads;
+	 * nullptr if it reads none
+	 * @throws std::invalid_argument if the name is already registered
+	 */
+	void add_pass(
+		std::string name, std::uint32_t rng_streams, PassFunction run,
+		ConfigHashFunction hash_config = nullptr
+	);
+
+	/**
+	 * @brief Get the names of the registered passes in run order
+	 */
+	std::vector<std::string_view> pass_names() const;
+
+	/**
+	 * @brief Install a probe to report heap allocations per pass
+	 * @param probe Probe function, or nullptr to disable
+	 */
+	void set_allocation_probe(AllocationProbe probe) noexcept {
+		allocation_probe_ = probe;
+	}
+
+	/**
+	 * @brief Enable counting the tiles and biomes each pass changes
+	 *
+	 * Counting compares the map against a copy taken before every pass, so
+	 * it is off by default.
+	 * @param enabled True to fill PassReport::tiles_written and
+	 * biomes_written
+	 */
+	void set_count_writes(bool enabled) noexcept {
+		count_writes_ = enabled;
+	}
+
+	/**
+	 * @brief Compute the input key of every pass
+	 * @param config Generation configuration
+	 * @param map_size Number of chunks per side of the generated map
+	 * @param origin_x World X coordinate of the map, see TileMap::set_origin()
+	 * @param origin_y World Y coordinate of the map
+	 * @return One key per pass in run order; the last one identifies the
+	 * whole generation
+	 */
+	std::vector<std::uint64_t> stage_keys(
+		const GenerationConfig &config, ChunkCoord map_size,
+		ChunkCoord origin_x = 0, ChunkCoord origin_y = 0
+	) const;
+
+	/**
+	 * @brief Run all passes in order on the tilemap
+	 * @param tilemap The tilemap to generate into
+	 * @param config Generation configuration, its seed drives the RNG streams
+	 * @param pool Worker pool handed to the passes
+	 * @param snapshots If not null, restore the latest snapshot whose key
+	 * still matches instead of rerunning the passes up to it, and store a
+	 * snapshot after every pass that runs
+	 * @return Per-pass measurements
+	 * @note Tile layers of the tilemap are disabled while the passes run and
+	 * rebuilt once afterwards; if a pass throws, they stay disabled
+	 */
+	PipelineReport run(
+		TileMap &tilemap, const GenerationConfig &config, WorkerPool &pool,
+		PassSnapshotCache *snapshots = nullptr
+	) const;
+};
+
+} // namespace istd
+
+#endif
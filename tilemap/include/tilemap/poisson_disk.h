@@ -0,0 +1,116 @@
+#ifndef ISTD_TILEMAP_POISSON_DISK_H
+#define ISTD_TILEMAP_POISSON_DISK_H
+
+#include "tilemap/chunk.h"
+#include "tilemap/tilemap.h"
+#include "tilemap/xoroshiro.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace istd {
+
+/**
+ * @brief Collect all tiles matching a predicate, in row-major global order
+ * @param tilemap The tilemap to scan
+ * @param pred Predicate taking a TilePos and returning bool
+ * @return Positions of the matching tiles
+ */
+template<typename Pred>
+std::vector<TilePos> collect_tiles(const TileMap &tilemap, Pred pred) {
+	const GlobalCoord width = tilemap.get_size() * Chunk::size;
+	std::vector<TilePos> tiles;
+	for (GlobalCoord global_x = 0; global_x < width; ++global_x) {
+		for (GlobalCoord global_y = 0; global_y < width; ++global_y) {
+			TilePos pos = TilePos::from_global(global_x, global_y);
+			if (pred(pos)) {
+				tiles.push_back(pos);
+			}
+		}
+	}
+	return tiles;
+}
+
+/**
+ * @brief Dart-throwing Poisson disk sampler backed by a spatial hash grid
+ *
+ * Accepted points are bucketed in a grid whose cells are at most
+ * min_distance / sqrt(2) wide, so every cell holds at most one point and a
+ * distance check only visits a constant number of cells.
+ */
+class PoissonDiskSampler {
+private:
+	std::uint32_t min_distance_;
+	std::uint32_t cell_size_;
+	std::uint32_t grid_width_;
+	std::uint32_t reach_; // Cells to visit in each direction
+	std::vector<std::uint32_t> grid_; // Point index per cell, or empty_cell
+	std::vector<TilePos> points_;
+
+	static constexpr std::uint32_t empty_cell = UINT32_MAX;
+
+	std::uint32_t cell_of(GlobalCoord global) const noexcept {
+		return global / cell_size_;
+	}
+
+public:
+	/**
+	 * @brief Construct a sampler for a map
+	 * @param map_size Size of the map in chunks
+	 * @param min_distance Minimum distance between accepted points in tiles
+	 */
+	PoissonDiskSampler(ChunkCoord map_size, std::uint32_t min_distance);
+
+	/**
+	 * @brief Check that no accepted point is closer than the minimum distance
+	 */
+	bool is_far_enough(TilePos pos) const;
+
+	/**
+	 * @brief Accept a point; it must pass is_far_enough()
+	 */
+	void insert(TilePos pos);
+
+	/**
+	 * @brief Get the accepted points in acceptance order
+	 */
+	const std::vector<TilePos> &points() const noexcept {
+		return points_;
+	}
+
+	/**
+	 * @brief Draw candidates uniformly until enough points are accepted
+	 * @param candidates Positions to draw from
+	 * @param target Number of points to accept
+	 * @param max_attempts Maximum number of candidates to draw
+	 * @param rng Random number generator for drawing candidates
+	 * @param accept Additional acceptance test taking a TilePos, evaluated
+	 * only for candidates that pass the distance check
+	 * @return The accepted points
+	 */
+	template<typename Accept>
+	const std::vector<TilePos> &sample(
+		const std::vector<TilePos> &candidates, std::uint32_t target,
+		std::uint32_t max_attempts, Xoroshiro128PP &rng, Accept accept
+	) {
+		if (candidates.empty()) {
+			return points_;
+		}
+
+		std::uniform_int_distribution<std::uint32_t> dist(
+			0, candidates.size() - 1
+		);
+		for (std::uint32_t attempts = 0;
+		     points_.size() < target && attempts < max_attempts; ++attempts) {
+			TilePos candidate = candidates[dist(rng)];
+			if (is_far_enough(candidate) && accept(candidate)) {
+				insert(candidate);
+			}
+		}
+		return points_;
+	}
+};
+
+} // namespace istd
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef ISTD_TILEMAP_TILE_LAYERS_H
+#define ISTD_TILEMAP_TILE_LAYERS_H
+
+#include "tilemap/chunk.h"
+#include "tilemap/tile.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace istd {
+
+/**
+ * @brief Tile classes kept as bit planes by TileMap::enable_layers()
+ */
+enum class TileLayer : std::uint8_t {
+	Impassable, // Mountain tiles
+	Water,      // Water and deepwater tiles
+};
+
+inline constexpr std::size_t tile_layer_count = 2;
+
+/**
+ * @brief Check if a tile belongs to a layer
+ */
+inline bool is_in_layer(TileLayer layer, Tile tile) noexcept {
+	switch (layer) {
+	case TileLayer::Impassable:
+		return tile.base == BaseTileType::Mountain;
+	case TileLayer::Water:
+		return tile.base == BaseTileType::Water
+			|| tile.base == BaseTileType::Deepwater;
+	}
+	return false;
+}
+
+/**
+ * @brief Bit planes of the tiles of one chunk, one 64-bit word per tile row,
+ * with an occupancy bit per sub-chunk so queries can skip empty areas
+ */
+struct ChunkLayers {
+	static constexpr std::size_t subchunk_words = Chunk::subchunk_count
+		* Chunk::subchunk_count / 64;
+
+	// Bit local_y of rows[layer][local_x] is set iff the tile is in the layer
+	std::uint64_t rows[tile_layer_count][Chunk::size]{};
+
+	// Bit (sub_x * subchunk_count + sub_y) % 64 of word
+	// (sub_x * subchunk_count + sub_y) / 64 is set iff any tile of the
+	// sub-chunk is in the layer
+	std::uint64_t subchunks[tile_layer_count][subchunk_words]{};
+
+	/**
+	 * @brief Get the bits of a row of 64 tiles, bit local_y for each tile
+	 */
+	std::uint64_t row(TileLayer layer, std::uint8_t local_x) const noexcept {
+		return rows[static_cast<std::size_t>(layer)][local_x];
+	}
+
+	/**
+	 * @brief Check if any tile of the chunk is in a layer
+	 */
+	bool any(TileLayer layer) const noexcept {
+		std::uint64_t bits = 0;
+		for (std::uint64_t word : subchunks[static_cast<std::size_t>(layer)]) {
+			bits |= word;
+		}
+		return bits != 0;
+	}
+
+	/**
+	 * @brief Check if any tile of a sub-chunk is in a layer
+	 */
+	bool any_in_subchunk(
+		TileLayer layer, std::uint8_t sub_x, std::uint8_t sub_y
+	) const noexcept {
+		const std::size_t bit = sub_x * Chunk::subchunk_count + sub_y;
+		return subchunks[static_cast<std::size_t>(layer)][bit / 64]
+			>> (bit % 64) & 1;
+	}
+
+	/**
+	 * @brief Update the bits of one tile
+	 */
+	void update(
+		std::uint8_t local_x, std::uint8_t local_y, Tile tile
+	) noexcept {
+		const std::uint64_t bit = std::uint64_t(1) << local_y;
+		for (std::size_t layer = 0; layer < tile_layer_count; ++layer) {
+			std::uint64_t &row = rows[layer][local_x];
+			if (is_in_layer(static_cast<TileLayer>(layer), tile)) {
+				row |= bit;
+			} else {
+				row &= ~bit;
+			}
+			update_subchunk(
+				layer, local_x / Chunk::subchunk_size,
+				local_y / Chunk::subchunk_size
+			);
+		}
+	}
+
+	/**
+	 * @brief Recompute all bits from the tiles of a chunk
+	 */
+	void rebuild(const Chunk &chunk) noexcept;
+
+private:
+	void update_subchunk(
+		std::size_t layer, std::uint8_t sub_x, std::uint8_t sub_y
+	) noexcept {
+		std::uint64_t sub_rows = 0;
+		for (std::uint8_t x = 0; x < Chunk::subchunk_size; ++x) {
+			sub_rows |= rows[layer][sub_x * Chunk::subchunk_size + x];
+		}
+		constexpr std::uint64_t mask = (1u << Chunk::subchunk_size) - 1;
+
+		const std::size_t bit = sub_x * Chunk::subchunk_count + sub_y;
+		std::uint64_t &word = subchunks[layer][bit / 64];
+		if (sub_rows >> (sub_y * Chunk::subchunk_size) & mask) {
+			word |= std::uint64_t(1) << (bit % 64);
+		} else {
+			word &= ~(std::uint64_t(1) << (bit % 64));
+		}
+	}
+};
+
+} // namespace istd
+
+#endif
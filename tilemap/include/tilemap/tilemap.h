@@ -2,37 +2,297 @@
 #define ISTD_TILEMAP_TILEMAP_H
 
 #include "tilemap/chunk.h"
+#include "tilemap/tile_layers.h"
+#include <array>
 #include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace istd {
 
+class MappedFile;
+
+/**
+ * @brief Fixed-capacity list of neighbor positions, stored inline
+ * @tparam Chebyshev If true, holds up to 8 neighbors (8-connected), otherwise
+ * up to 4 neighbors (4-connected)
+ */
+template<bool Chebyshev>
+class NeighborList {
+public:
+	static constexpr std::uint8_t capacity = Chebyshev ? 8 : 4;
+
+private:
+	std::array<TilePos, capacity> positions_;
+	std::uint8_t size_ = 0;
+
+public:
+	void push_back(TilePos pos) noexcept {
+		positions_[size_++] = pos;
+	}
+
+	std::uint8_t size() const noexcept {
+		return size_;
+	}
+
+	bool empty() const noexcept {
+		return size_ == 0;
+	}
+
+	/**
+	 * @brief Check if some neighbors were dropped by the map boundary
+	 * @return True if the center tile lies on the map border
+	 */
+	bool at_border() const noexcept {
+		return size_ < capacity;
+	}
+
+	TilePos operator[](std::uint8_t i) const noexcept {
+		return positions_[i];
+	}
+
+	auto begin() noexcept {
+		return positions_.begin();
+	}
+
+	auto end() noexcept {
+		return positions_.begin() + size_;
+	}
+
+	auto begin() const noexcept {
+		return positions_.begin();
+	}
+
+	auto end() const noexcept {
+		return positions_.begin() + size_;
+	}
+};
+
+/**
+ * @brief How a TileMap allocates its chunks
+ */
+enum class ChunkAllocation : std::uint8_t {
+	// All chunks up front, in one contiguous block
+	Eager,
+	// Each chunk when first accessed through a non-const reference; reads of
+	// missing chunks through a const reference see default tiles and biomes
+	OnDemand,
+};
+
 class TileMap {
 private:
-	std::uint8_t size_; // Number of chunks in each dimension (n×n)
-	std::vector<std::vector<Chunk>> chunks_; // 2D array of chunks
+	// On-demand chunks are found through a two-level directory of pages, each
+	// holding the chunk pointers of a 64x64 chunk area
+	static constexpr unsigned page_bits = 6;
+	static constexpr ChunkCoord page_side = 1 << page_bits;
+
+	struct DirectoryPage {
+		std::array<Chunk *, page_side * page_side> chunks{};
+		std::array<ChunkLayers *, page_side * page_side> layers{};
+	};
+
+	static const Chunk empty_chunk_; // Seen by const reads of missing chunks
+	static const ChunkLayers empty_layers_; // Layers of empty_chunk_
+
+	ChunkCoord size_;            // Number of chunks in each dimension (n×n)
+	ChunkCoord origin_x_ = 0;    // World position of chunk (0, 0)
+	ChunkCoord origin_y_ = 0;
+	Chunk *contiguous_ = nullptr; // All chunks, indexed x * size + y, if eager
+	std::vector<Chunk> heap_chunks_;      // Eager storage unless mapped
+	std::shared_ptr<MappedFile> mapping_; // File holding the chunks if mapped
+	std::vector<std::unique_ptr<DirectoryPage>> pages_; // On-demand directory
+	std::deque<Chunk> sparse_chunks_; // On-demand storage, addresses stable
+	bool layers_enabled_ = false;
+	std::vector<ChunkLayers> heap_layers_;  // Eager layers, same order
+	std::deque<ChunkLayers> sparse_layers_; // On-demand layers
+
+	DirectoryPage *find_page(
+		ChunkCoord chunk_x, ChunkCoord chunk_y
+	) const noexcept {
+		return pages_[
+			(chunk_x >> page_bits) * ((size_ + page_side - 1) >> page_bits)
+			+ (chunk_y >> page_bits)
+		].get();
+	}
+
+	static std::size_t page_slot(
+		ChunkCoord chunk_x, ChunkCoord chunk_y
+	) noexcept {
+		return (chunk_x % page_side) * page_side + chunk_y % page_side;
+	}
+
+	Chunk *find_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y) const noexcept {
+		const DirectoryPage *page = find_page(chunk_x, chunk_y);
+		return page ? page->chunks[page_slot(chunk_x, chunk_y)] : nullptr;
+	}
+
+	// Layers must be enabled; missing chunks read as empty_layers_
+	const ChunkLayers &find_layers(
+		ChunkCoord chunk_x, ChunkCoord chunk_y
+	) const noexcept {
+		if (contiguous_) {
+			return heap_layers_[std::size_t(chunk_x) * size_ + chunk_y];
+		}
+		const DirectoryPage *page = find_page(chunk_x, chunk_y);
+		const ChunkLayers *layers = page
+			? page->layers[page_slot(chunk_x, chunk_y)]
+			: nullptr;
+		return layers ? *layers : empty_layers_;
+	}
+
+	// Layers must be enabled and the chunk allocated
+	ChunkLayers &layers_of(ChunkCoord chunk_x, ChunkCoord chunk_y) noexcept {
+		if (contiguous_) {
+			return heap_layers_[std::size_t(chunk_x) * size_ + chunk_y];
+		}
+		DirectoryPage *page = find_page(chunk_x, chunk_y);
+		return *page->layers[page_slot(chunk_x, chunk_y)];
+	}
+
+	Chunk &allocate_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y);
 
 public:
+	/**
+	 * @brief Largest supported number of chunks per side
+	 */
+	static constexpr ChunkCoord max_size = 65535;
+
 	/**
 	 * @brief Construct a TileMap with n×n chunks
-	 * @param size Number of chunks in each dimension (max 100)
+	 * @param size Number of chunks in each dimension (1 to max_size)
+	 * @param allocation Whether to allocate all chunks now or on first access
+	 * @note Eager maps take 4352 bytes per chunk; on-demand maps take that per
+	 * allocated chunk, plus 8 bytes per chunk slot of every 64x64 chunk area
+	 * holding an allocated chunk
+	 */
+	explicit TileMap(
+		ChunkCoord size, ChunkAllocation allocation = ChunkAllocation::Eager
+	);
+
+	/**
+	 * @brief Construct a TileMap over chunks stored in a mapped file
+	 * @param size Number of chunks in each dimension (1 to max_size)
+	 * @param mapping Mapped file, kept alive by the TileMap
+	 * @param chunk_offset Byte offset of the first chunk in the mapping;
+	 * size * size chunks must follow contiguously
+	 * @throws std::invalid_argument if the chunks do not fit in the mapping
+	 * @note Writes through the TileMap follow the MapMode of the mapping
+	 */
+	TileMap(
+		ChunkCoord size, std::shared_ptr<MappedFile> mapping,
+		std::size_t chunk_offset
+	);
+
+	/**
+	 * @brief Copy a TileMap; the copy owns its chunks on the heap and
+	 * allocates them the same way as the original
 	 */
-	explicit TileMap(std::uint8_t size);
+	TileMap(const TileMap &other);
+
+	/**
+	 * @brief Copy the chunks of another TileMap
+	 *
+	 * If both maps have the same size and this map is eager, the chunks are
+	 * copied into the existing storage (which may be a mapped file), otherwise
+	 * it is replaced by a copy of the other map.
+	 */
+	TileMap &operator=(const TileMap &other);
+
+	TileMap(TileMap &&other) noexcept;
+	TileMap &operator=(TileMap &&other) noexcept;
 
 	/**
 	 * @brief Get the size of the tilemap (number of chunks per side)
 	 */
-	std::uint8_t get_size() const {
+	ChunkCoord get_size() const {
 		return size_;
 	}
 
+	/**
+	 * @brief Place the map as a window into a larger world
+	 *
+	 * Generation passes sample their noise at world coordinates, so a window
+	 * generates the same terrain as the world has at its place, except where
+	 * a pass looks across the window border.
+	 * @param origin_x World X coordinate of chunk (0, 0)
+	 * @param origin_y World Y coordinate of chunk (0, 0)
+	 * @throws std::invalid_argument if the window would reach past max_size
+	 */
+	void set_origin(ChunkCoord origin_x, ChunkCoord origin_y);
+
+	ChunkCoord origin_x() const noexcept {
+		return origin_x_;
+	}
+
+	ChunkCoord origin_y() const noexcept {
+		return origin_y_;
+	}
+
+	/**
+	 * @brief Get the world coordinates of a tile, i.e. its global coordinates
+	 * offset by the origin
+	 */
+	std::pair<GlobalCoord, GlobalCoord> world_coords(
+		TilePos pos
+	) const noexcept {
+		auto [global_x, global_y] = pos.to_global();
+		return {
+			global_x + static_cast<GlobalCoord>(origin_x_) * Chunk::size,
+			global_y + static_cast<GlobalCoord>(origin_y_) * Chunk::size
+		};
+	}
+
+	/**
+	 * @brief Get how the chunks are allocated; mapped maps are eager
+	 */
+	ChunkAllocation allocation() const noexcept {
+		return contiguous_ ? ChunkAllocation::Eager : ChunkAllocation::OnDemand;
+	}
+
+	/**
+	 * @brief Get the contiguous chunk storage of an eager map, indexed
+	 * x * size + y
+	 * @return All chunks, or an empty span for on-demand maps
+	 */
+	std::span<Chunk> chunks() noexcept {
+		return {contiguous_, contiguous_ ? std::size_t(size_) * size_ : 0};
+	}
+
+	std::span<const Chunk> chunks() const noexcept {
+		return {contiguous_, contiguous_ ? std::size_t(size_) * size_ : 0};
+	}
+
+	/**
+	 * @brief Check if a chunk is allocated; always true for eager maps
+	 * @throws std::out_of_range if the coordinates are outside the map
+	 */
+	bool has_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y) const;
+
+	/**
+	 * @brief Get the number of allocated chunks
+	 */
+	std::size_t chunk_count() const noexcept {
+		return contiguous_ ? std::size_t(size_) * size_ : sparse_chunks_.size();
+	}
+
+	/**
+	 * @brief Get the mapped file holding the chunks, or nullptr if the chunks
+	 * live on the heap
+	 */
+	const std::shared_ptr<MappedFile> &mapping() const noexcept {
+		return mapping_;
+	}
+
 	/**
 	 * @brief Get a reference to a chunk at the given coordinates
 	 * @param chunk_x X coordinate of the chunk
 	 * @param chunk_y Y coordinate of the chunk
 	 */
-	Chunk &get_chunk(std::uint8_t chunk_x, std::uint8_t chunk_y);
-	const Chunk &get_chunk(std::uint8_t chunk_x, std::uint8_t chunk_y) const;
+	Chunk &get_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y);
+	const Chunk &get_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y) const;
 
 	/**
 	 * @brief Get a reference to the chunk containing the given TilePos
@@ -55,6 +315,153 @@ public:
 	 */
 	void set_tile(TilePos pos, const Tile &tile);
 
+	/**
+	 * @brief Get a chunk without bounds checking
+	 * @param chunk_x X coordinate of the chunk, must be less than get_size()
+	 * @param chunk_y Y coordinate of the chunk, must be less than get_size()
+	 * @note Allocates a missing chunk of an on-demand map, which may throw
+	 * std::bad_alloc
+	 */
+	Chunk &get_chunk_unchecked(ChunkCoord chunk_x, ChunkCoord chunk_y) {
+		if (contiguous_) {
+			return contiguous_[std::size_t(chunk_x) * size_ + chunk_y];
+		}
+		Chunk *chunk = find_chunk(chunk_x, chunk_y);
+		return chunk ? *chunk : allocate_chunk(chunk_x, chunk_y);
+	}
+
+	const Chunk &get_chunk_unchecked(
+		ChunkCoord chunk_x, ChunkCoord chunk_y
+	) const noexcept {
+		if (contiguous_) {
+			return contiguous_[std::size_t(chunk_x) * size_ + chunk_y];
+		}
+		const Chunk *chunk = find_chunk(chunk_x, chunk_y);
+		return chunk ? *chunk : empty_chunk_;
+	}
+
+	/**
+	 * @brief Get a tile without bounds checking
+	 * @param pos The position of the tile, must be inside the map
+	 * @note Intended for hot loops whose positions are valid by construction,
+	 * use get_tile() for untrusted input
+	 */
+	Tile &get_tile_unchecked(TilePos pos) {
+		return get_chunk_unchecked(pos.chunk_x, pos.chunk_y)
+			.tiles[pos.local_x][pos.local_y];
+	}
+
+	const Tile &get_tile_unchecked(TilePos pos) const noexcept {
+		return get_chunk_unchecked(pos.chunk_x, pos.chunk_y)
+			.tiles[pos.local_x][pos.local_y];
+	}
+
+	/**
+	 * @brief Get a tile by global coordinates without bounds checking
+	 * @param global_x Global X coordinate, must be inside the map
+	 * @param global_y Global Y coordinate, must be inside the map
+	 */
+	Tile &get_tile_unchecked(GlobalCoord global_x, GlobalCoord global_y) {
+		Chunk &chunk = get_chunk_unchecked(
+			global_x / Chunk::size, global_y / Chunk::size
+		);
+		return chunk.tiles[global_x % Chunk::size][global_y % Chunk::size];
+	}
+
+	const Tile &get_tile_unchecked(
+		GlobalCoord global_x, GlobalCoord global_y
+	) const noexcept {
+		const Chunk &chunk = get_chunk_unchecked(
+			global_x / Chunk::size, global_y / Chunk::size
+		);
+		return chunk.tiles[global_x % Chunk::size][global_y % Chunk::size];
+	}
+
+	/**
+	 * @brief Set a tile without bounds checking
+	 * @param pos The position of the tile, must be inside the map
+	 * @param tile The tile to set
+	 * @note Not thread-safe while layers are enabled, even for distinct
+	 * tiles: the layer words are shared by the rows and sub-chunks around
+	 * the tile. Parallel writers go through get_tile_unchecked() and
+	 * rebuild the layers afterwards.
+	 */
+	void set_tile_unchecked(TilePos pos, const Tile &tile) {
+		get_tile_unchecked(pos) = tile;
+		if (layers_enabled_) {
+			layers_of(pos.chunk_x, pos.chunk_y)
+				.update(pos.local_x, pos.local_y, tile);
+		}
+	}
+
+	/**
+	 * @brief Build the tile layers from the current tiles and keep them up
+	 * to date from now on
+	 *
+	 * Layers are bit planes of tile classes (see TileLayer), 64 tiles per
+	 * word, so a query can test a row of tiles with one word operation, plus
+	 * an occupancy bit per sub-chunk for skipping empty areas. They take
+	 * about 1 KiB per allocated chunk. set_tile() and set_tile_unchecked()
+	 * update them; writes through tile or chunk references, as generation
+	 * passes do, do not, so call this again after such writes.
+	 */
+	void enable_layers();
+
+	/**
+	 * @brief Drop the tile layers
+	 */
+	void disable_layers() noexcept;
+
+	bool has_layers() const noexcept {
+		return layers_enabled_;
+	}
+
+	/**
+	 * @brief Get the layers of a chunk without bounds checking
+	 * @note Layers must be enabled; missing chunks of an on-demand map read
+	 * as the layers of a default chunk
+	 */
+	const ChunkLayers &get_chunk_layers_unchecked(
+		ChunkCoord chunk_x, ChunkCoord chunk_y
+	) const noexcept {
+		return find_layers(chunk_x, chunk_y);
+	}
+
+	/**
+	 * @brief Check if a tile is in a layer without bounds checking
+	 * @param layer The layer to test
+	 * @param global_x Global X coordinate, must be inside the map
+	 * @param global_y Global Y coordinate, must be inside the map
+	 * @note Reads the tile itself if layers are not enabled
+	 */
+	bool tile_in_layer(
+		TileLayer layer, GlobalCoord global_x, GlobalCoord global_y
+	) const noexcept {
+		if (!layers_enabled_) {
+			return is_in_layer(layer, get_tile_unchecked(global_x, global_y));
+		}
+		const ChunkLayers &layers = find_layers(
+			global_x / Chunk::size, global_y / Chunk::size
+		);
+		return layers.row(layer, global_x % Chunk::size)
+			>> (global_y % Chunk::size) & 1;
+	}
+
+	/**
+	 * @brief Check if any tile of a row segment is in a layer, without
+	 * bounds checking
+	 * @param layer The layer to test
+	 * @param global_x Global X coordinate of the row, must be inside the map
+	 * @param global_y Global Y coordinate of the first tile
+	 * @param length Number of tiles; the segment must end inside the map
+	 * @note Tests a word per chunk the segment crosses if layers are
+	 * enabled, otherwise reads every tile
+	 */
+	bool any_in_layer_row(
+		TileLayer layer, GlobalCoord global_x, GlobalCoord global_y,
+		GlobalCoord length
+	) const noexcept;
+
 	/**
 	 * @brief Check if a position is at the map boundary
 	 * @param pos The position to check
@@ -72,6 +479,40 @@ public:
 	std::vector<TilePos> get_neighbors(
 		TilePos pos, bool chebyshev = false
 	) const;
+
+	/**
+	 * @brief Get all valid neighbors of a position without heap allocation
+	 * @tparam Chebyshev If true, use Chebyshev distance (8-connected),
+	 * otherwise Manhattan distance (4-connected)
+	 * @param pos The position to get neighbors for
+	 * @return Neighbor list in the same order as get_neighbors()
+	 */
+	template<bool Chebyshev = false>
+	NeighborList<Chebyshev> neighbors_of(TilePos pos) const noexcept {
+		constexpr int dx[] = {-1, 1, 0, 0, -1, 1, -1, 1};
+		constexpr int dy[] = {0, 0, -1, 1, -1, -1, 1, 1};
+
+		NeighborList<Chebyshev> neighbors;
+		const int global_x = pos.chunk_x * Chunk::size + pos.local_x;
+		const int global_y = pos.chunk_y * Chunk::size + pos.local_y;
+		const int max_global = size_ * Chunk::size - 1;
+		for (int i = 0; i < NeighborList<Chebyshev>::capacity; ++i) {
+			int new_global_x = global_x + dx[i];
+			int new_global_y = global_y + dy[i];
+			if (new_global_x < 0 || new_global_x > max_global
+			    || new_global_y < 0 || new_global_y > max_global) {
+				continue;
+			}
+
+			neighbors.push_back({
+				static_cast<ChunkCoord>(new_global_x / Chunk::size),
+				static_cast<ChunkCoord>(new_global_y / Chunk::size),
+				static_cast<std::uint8_t>(new_global_x % Chunk::size),
+				static_cast<std::uint8_t>(new_global_y % Chunk::size),
+			});
+		}
+		return neighbors;
+	}
 };
 
 } // namespace istd
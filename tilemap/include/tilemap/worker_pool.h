@@ -0,0 +1,74 @@
+#ifndef ISTD_TILEMAP_WORKER_POOL_H
+#define ISTD_TILEMAP_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace istd {
+
+/**
+ * @brief Fixed-size pool of worker threads for data-parallel generation jobs
+ *
+ * The calling thread takes part in every job, so a pool of size 1 owns no
+ * threads at all and runs jobs inline.
+ */
+class WorkerPool {
+private:
+	std::vector<std::jthread> workers_;
+	std::mutex mutex_;
+	std::condition_variable wake_cv_;
+	std::condition_variable done_cv_;
+
+	// Current job, guarded by mutex_
+	const std::function<void(std::uint32_t)> *job_ = nullptr;
+	std::uint32_t job_count_ = 0;
+	std::uint64_t generation_ = 0;
+	std::uint32_t busy_workers_ = 0;
+	bool stopping_ = false;
+
+	std::atomic<std::uint32_t> next_index_;
+
+	void worker_loop();
+	void run_indices(
+		const std::function<void(std::uint32_t)> &job, std::uint32_t count
+	);
+
+public:
+	/**
+	 * @brief Construct a worker pool
+	 * @param threads Total number of threads including the caller (min 1)
+	 */
+	explicit WorkerPool(std::uint32_t threads);
+
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	/**
+	 * @brief Get the number of threads that execute jobs, including the
+	 * caller
+	 */
+	std::uint32_t size() const noexcept {
+		return workers_.size() + 1;
+	}
+
+	/**
+	 * @brief Run job(i) for every i in [0, count) and wait for completion
+	 * @param count Number of job indices
+	 * @param job Job to run, must not throw; indices are handed out in no
+	 * particular order, so jobs must not depend on each other
+	 */
+	void parallel_for(
+		std::uint32_t count, const std::function<void(std::uint32_t)> &job
+	);
+};
+
+} // namespace istd
+
+#endif
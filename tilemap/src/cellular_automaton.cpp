@@ -0,0 +1,23 @@
+#include "tilemap/cellular_automaton.h"
+#include <algorithm>
+
+namespace istd {
+
+void CellularAutomaton::snapshot(const TileMap &tilemap, WorkerPool &pool) {
+	const ChunkCoord map_size = tilemap.get_size();
+	width_ = map_size * Chunk::size;
+	front_.resize(static_cast<std::size_t>(width_) * width_);
+
+	pool.parallel_for(width_, [&](std::uint32_t x) {
+		Tile *dest = front_.data() + std::size_t(x) * width_;
+		for (ChunkCoord chunk_y = 0; chunk_y < map_size; ++chunk_y) {
+			const Chunk &chunk = tilemap.get_chunk_unchecked(
+				x / Chunk::size, chunk_y
+			);
+			const auto &row = chunk.tiles[x % Chunk::size];
+			dest = std::copy(std::begin(row), std::end(row), dest);
+		}
+	});
+}
+
+} // namespace istd
@@ -0,0 +1,243 @@
+#include "tilemap/compact_chunk.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace istd {
+
+namespace {
+
+std::uint8_t tile_key(Tile tile) noexcept {
+	return static_cast<std::uint8_t>(tile.base)
+		| static_cast<std::uint8_t>(tile.surface) << 4;
+}
+
+// Number of 64-bit words holding the indices of a chunk
+constexpr std::size_t index_words(std::uint8_t bits) noexcept {
+	return CompactChunk::tile_count * bits / 64;
+}
+
+} // namespace
+
+std::uint8_t CompactChunk::index_bits(std::size_t palette_size) noexcept {
+	if (palette_size <= 1) {
+		return 0;
+	}
+	if (palette_size <= 2) {
+		return 1;
+	}
+	return palette_size <= 4 ? 2 : 4;
+}
+
+CompactChunk::CompactChunk(const Chunk &chunk): palette_size_(0) {
+	// Palette slot of every possible tile value, 0xFF if not in the palette
+	std::array<std::uint8_t, 256> slots;
+	slots.fill(0xFF);
+	for (const auto &row : chunk.tiles) {
+		for (Tile tile : row) {
+			std::uint8_t &slot = slots[tile_key(tile)];
+			if (slot != 0xFF) {
+				continue;
+			}
+			if (palette_size_ == max_palette_size) {
+				full_ = std::make_unique<Chunk>(chunk);
+				return;
+			}
+			slot = palette_size_;
+			palette_[palette_size_++] = tile;
+		}
+	}
+
+	bits_ = index_bits(palette_size_);
+	indices_.assign(index_words(bits_), 0);
+	std::uint32_t bit = 0;
+	for (const auto &row : chunk.tiles) {
+		for (Tile tile : row) {
+			if (bits_ != 0) {
+				indices_[bit / 64] |= std::uint64_t(slots[tile_key(tile)])
+					<< (bit % 64);
+			}
+			bit += bits_;
+		}
+	}
+
+	const BiomeType *biomes = &chunk.biome[0][0];
+	biome_fill_ = biomes[0];
+	if (!std::all_of(biomes, biomes + biome_count, [this](BiomeType biome) {
+		    return biome == biome_fill_;
+	    })) {
+		biomes_.assign(biomes, biomes + biome_count);
+	}
+}
+
+CompactChunk::CompactChunk(
+	std::span<const Tile> palette, std::span<const std::uint64_t> indices,
+	std::span<const BiomeType> biomes
+)
+	: bits_(index_bits(palette.size()))
+	, palette_size_(static_cast<std::uint8_t>(palette.size())) {
+	if (palette.empty() || palette.size() > max_palette_size
+	    || indices.size() != index_words(bits_)
+	    || biomes.size() != biome_count) {
+		throw std::invalid_argument("Invalid compact chunk data");
+	}
+	std::ranges::copy(palette, palette_.begin());
+	indices_.assign(indices.begin(), indices.end());
+
+	biome_fill_ = biomes[0];
+	if (std::ranges::count(biomes, biome_fill_) != biome_count) {
+		biomes_.assign(biomes.begin(), biomes.end());
+	}
+}
+
+CompactChunk::CompactChunk(const CompactChunk &other)
+	: bits_(other.bits_)
+	, palette_size_(other.palette_size_)
+	, palette_(other.palette_)
+	, indices_(other.indices_)
+	, biome_fill_(other.biome_fill_)
+	, biomes_(other.biomes_)
+	, full_(other.full_ ? std::make_unique<Chunk>(*other.full_) : nullptr) {}
+
+CompactChunk &CompactChunk::operator=(const CompactChunk &other) {
+	if (this != &other) {
+		*this = CompactChunk(other);
+	}
+	return *this;
+}
+
+void CompactChunk::expand() {
+	auto chunk = std::make_unique<Chunk>();
+	decompress(*chunk);
+	full_ = std::move(chunk);
+	// Release the compact storage
+	indices_ = {};
+	biomes_ = {};
+}
+
+void CompactChunk::set_tile(
+	std::uint8_t local_x, std::uint8_t local_y, Tile tile
+) {
+	if (!full_) {
+		if (get_tile(local_x, local_y) == tile) {
+			return;
+		}
+		expand();
+	}
+	full_->tiles[local_x][local_y] = tile;
+}
+
+void CompactChunk::set_biome(SubChunkPos pos, BiomeType biome) {
+	if (!full_) {
+		if (get_biome(pos) == biome) {
+			return;
+		}
+		expand();
+	}
+	full_->get_biome(pos) = biome;
+}
+
+void CompactChunk::decompress(Chunk &chunk) const {
+	if (full_) {
+		chunk = *full_;
+		return;
+	}
+
+	if (bits_ == 0) {
+		std::fill_n(&chunk.tiles[0][0], tile_count, palette_[0]);
+	} else {
+		const std::uint64_t mask = (std::uint64_t(1) << bits_) - 1;
+		Tile *out = &chunk.tiles[0][0];
+		for (std::uint64_t word : indices_) {
+			for (int shift = 0; shift < 64; shift += bits_) {
+				*out++ = palette_[(word >> shift) & mask];
+			}
+		}
+	}
+
+	BiomeType *biomes = &chunk.biome[0][0];
+	if (biomes_.empty()) {
+		std::fill_n(biomes, biome_count, biome_fill_);
+	} else {
+		std::ranges::copy(biomes_, biomes);
+	}
+}
+
+std::size_t CompactChunk::heap_bytes() const noexcept {
+	return indices_.capacity() * sizeof(std::uint64_t) + biomes_.capacity()
+		+ (full_ ? sizeof(Chunk) : 0);
+}
+
+CompactTileMap::CompactTileMap(ChunkCoord size): size_(size) {
+	if (size == 0) {
+		throw std::invalid_argument("TileMap size must be between 1 and 65535");
+	}
+	chunks_.resize(static_cast<std::size_t>(size) * size);
+}
+
+CompactTileMap::CompactTileMap(const TileMap &tilemap)
+	: size_(tilemap.get_size()) {
+	chunks_.reserve(std::size_t(size_) * size_);
+	for (ChunkCoord chunk_x = 0; chunk_x < size_; ++chunk_x) {
+		for (ChunkCoord chunk_y = 0; chunk_y < size_; ++chunk_y) {
+			chunks_.emplace_back(tilemap.get_chunk_unchecked(chunk_x, chunk_y));
+		}
+	}
+}
+
+CompactChunk &CompactTileMap::get_chunk(
+	ChunkCoord chunk_x, ChunkCoord chunk_y
+) {
+	if (chunk_x >= size_ || chunk_y >= size_) {
+		throw std::out_of_range("Chunk coordinates out of bounds");
+	}
+	return chunks_[std::size_t(chunk_x) * size_ + chunk_y];
+}
+
+const CompactChunk &CompactTileMap::get_chunk(
+	ChunkCoord chunk_x, ChunkCoord chunk_y
+) const {
+	if (chunk_x >= size_ || chunk_y >= size_) {
+		throw std::out_of_range("Chunk coordinates out of bounds");
+	}
+	return chunks_[std::size_t(chunk_x) * size_ + chunk_y];
+}
+
+Tile CompactTileMap::get_tile(TilePos pos) const {
+	if (pos.local_x >= Chunk::size || pos.local_y >= Chunk::size) {
+		throw std::out_of_range("Local coordinates out of bounds");
+	}
+	return get_chunk(pos.chunk_x, pos.chunk_y)
+		.get_tile(pos.local_x, pos.local_y);
+}
+
+void CompactTileMap::set_tile(TilePos pos, Tile tile) {
+	if (pos.local_x >= Chunk::size || pos.local_y >= Chunk::size) {
+		throw std::out_of_range("Local coordinates out of bounds");
+	}
+	get_chunk(pos.chunk_x, pos.chunk_y)
+		.set_tile(pos.local_x, pos.local_y, tile);
+}
+
+void CompactTileMap::decompress(TileMap &tilemap) const {
+	if (tilemap.get_size() != size_) {
+		throw std::invalid_argument("Tilemap size does not match");
+	}
+	for (ChunkCoord chunk_x = 0; chunk_x < size_; ++chunk_x) {
+		for (ChunkCoord chunk_y = 0; chunk_y < size_; ++chunk_y) {
+			chunks_[std::size_t(chunk_x) * size_ + chunk_y].decompress(
+				tilemap.get_chunk_unchecked(chunk_x, chunk_y)
+			);
+		}
+	}
+}
+
+std::size_t CompactTileMap::memory_usage() const noexcept {
+	std::size_t bytes = sizeof(*this)
+		+ chunks_.capacity() * sizeof(CompactChunk);
+	for (const CompactChunk &chunk : chunks_) {
+		bytes += chunk.heap_bytes();
+	}
+	return bytes;
+}
+
+} // namespace istd
@@ -0,0 +1,230 @@
+#include "tilemap/connected_components.h"
+#include <algorithm>
+
+namespace istd {
+
+namespace {
+
+// Runs and union-find forest of a horizontal stripe of rows
+struct Stripe {
+	std::uint32_t row_begin;
+	std::uint32_t row_end;
+	std::vector<TileRun> runs;
+	std::vector<std::uint32_t> row_offsets; // First run index of each row
+	std::vector<std::uint32_t> parent;
+};
+
+// Find the root of a run, halving the path on the way. The root of a set is
+// always its smallest run index.
+std::uint32_t find_root(std::vector<std::uint32_t> &parent, std::uint32_t i) {
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+void unite(
+	std::vector<std::uint32_t> &parent, std::uint32_t a, std::uint32_t b
+) {
+	a = find_root(parent, a);
+	b = find_root(parent, b);
+	if (a < b) {
+		parent[b] = a;
+	} else if (b < a) {
+		parent[a] = b;
+	}
+}
+
+// Unite the overlapping runs of two adjacent rows, given as index ranges into
+// the same run array
+void unite_rows(
+	const std::vector<TileRun> &runs, std::vector<std::uint32_t> &parent,
+	std::uint32_t prev_begin, std::uint32_t prev_end, std::uint32_t cur_begin,
+	std::uint32_t cur_end, bool chebyshev
+) {
+	// Diagonal neighbors extend the overlap test by one tile on each side
+	const std::uint32_t reach = chebyshev ? 1 : 0;
+	std::uint32_t i = prev_begin, j = cur_begin;
+	while (i < prev_end && j < cur_end) {
+		const TileRun &a = runs[i];
+		const TileRun &b = runs[j];
+		if (a.global_y_begin < b.global_y_end + reach
+		    && b.global_y_begin < a.global_y_end + reach) {
+			unite(parent, i, j);
+		}
+
+		if (a.global_y_end < b.global_y_end) {
+			++i;
+		} else {
+			++j;
+		}
+	}
+}
+
+void scan_stripe(
+	const TileMap &tilemap, const TileMask &mask, bool chebyshev,
+	Stripe &stripe
+) {
+	const ChunkCoord map_size = tilemap.get_size();
+
+	for (GlobalCoord x = stripe.row_begin; x < stripe.row_end; ++x) {
+		const std::uint32_t row_begin = stripe.runs.size();
+		stripe.row_offsets.push_back(row_begin);
+
+		const ChunkCoord chunk_x = x / Chunk::size;
+		const std::uint8_t local_x = x % Chunk::size;
+		bool in_run = false;
+		GlobalCoord run_begin = 0;
+		for (ChunkCoord chunk_y = 0; chunk_y < map_size; ++chunk_y) {
+			const Chunk &chunk = tilemap.get_chunk_unchecked(chunk_x, chunk_y);
+			const auto &row = chunk.tiles[local_x];
+			for (std::uint8_t local_y = 0; local_y < Chunk::size; ++local_y) {
+				auto tile_bits = std::bit_cast<std::uint8_t>(row[local_y]);
+				bool selected = mask[tile_bits];
+				if (selected == in_run) {
+					continue;
+				}
+
+				GlobalCoord y = chunk_y * Chunk::size + local_y;
+				if (selected) {
+					run_begin = y;
+				} else {
+					stripe.runs.push_back({x, run_begin, y});
+				}
+				in_run = selected;
+			}
+		}
+
+		if (in_run) {
+			stripe.runs.push_back({
+				x, run_begin, static_cast<GlobalCoord>(map_size * Chunk::size)
+			});
+		}
+
+		const std::uint32_t row_end = stripe.runs.size();
+		for (std::uint32_t i = row_begin; i < row_end; ++i) {
+			stripe.parent.push_back(i);
+		}
+
+		if (x > stripe.row_begin) {
+			const std::uint32_t prev_begin
+				= stripe.row_offsets[stripe.row_offsets.size() - 2];
+			unite_rows(
+				stripe.runs, stripe.parent, prev_begin, row_begin, row_begin,
+				row_end, chebyshev
+			);
+		}
+	}
+	stripe.row_offsets.push_back(stripe.runs.size());
+}
+
+} // namespace
+
+std::vector<TilePos> ComponentLabels::tiles_of(
+	const TileComponent &component
+) const {
+	std::vector<TilePos> tiles;
+	tiles.reserve(component.size);
+	for (const TileRun &run : runs_of(component)) {
+		for (GlobalCoord y = run.global_y_begin; y < run.global_y_end; ++y) {
+			tiles.push_back(TilePos::from_global(run.global_x, y));
+		}
+	}
+	return tiles;
+}
+
+ComponentLabels label_components(
+	const TileMap &tilemap, const TileMask &mask, bool chebyshev,
+	WorkerPool &pool
+) {
+	const std::uint32_t map_width = tilemap.get_size() * Chunk::size;
+	const std::uint32_t stripes = std::clamp<std::uint32_t>(
+		pool.size(), 1, map_width
+	);
+
+	// Phase 1: extract runs and unite them within each stripe
+	std::vector<Stripe> stripe_data(stripes);
+	for (std::uint32_t s = 0; s < stripes; ++s) {
+		stripe_data[s].row_begin = map_width * s / stripes;
+		stripe_data[s].row_end = map_width * (s + 1) / stripes;
+	}
+
+	pool.parallel_for(stripes, [&](std::uint32_t s) {
+		scan_stripe(tilemap, mask, chebyshev, stripe_data[s]);
+	});
+
+	// Phase 2: concatenate stripes and unite runs across stripe borders
+	std::vector<TileRun> runs;
+	std::vector<std::uint32_t> parent;
+	std::vector<std::uint32_t> stripe_offsets;
+	for (const Stripe &stripe : stripe_data) {
+		const std::uint32_t offset = runs.size();
+		stripe_offsets.push_back(offset);
+		runs.insert(runs.end(), stripe.runs.begin(), stripe.runs.end());
+		for (std::uint32_t p : stripe.parent) {
+			parent.push_back(p + offset);
+		}
+	}
+
+	for (std::uint32_t s = 1; s < stripes; ++s) {
+		const Stripe &above = stripe_data[s - 1];
+		const Stripe &below = stripe_data[s];
+		const std::uint32_t above_offset = stripe_offsets[s - 1];
+		const std::uint32_t below_offset = stripe_offsets[s];
+		const auto last_row = above.row_offsets.size() - 2;
+		unite_rows(
+			runs, parent, above_offset + above.row_offsets[last_row],
+			above_offset + above.row_offsets[last_row + 1],
+			below_offset + below.row_offsets[0],
+			below_offset + below.row_offsets[1], chebyshev
+		);
+	}
+
+	// Phase 3: assign component ids in scan order and accumulate statistics
+	ComponentLabels labels;
+	std::vector<std::uint32_t> component_of(runs.size());
+	for (std::uint32_t i = 0; i < runs.size(); ++i) {
+		const std::uint32_t root = find_root(parent, i);
+		if (root == i) {
+			component_of[i] = labels.components.size();
+			labels.components.push_back({0, false, 0, 0});
+		} else {
+			component_of[i] = component_of[root];
+		}
+
+		const TileRun &run = runs[i];
+		TileComponent &component = labels.components[component_of[i]];
+		component.size += run.global_y_end - run.global_y_begin;
+		component.run_count += 1;
+		component.touches_boundary = component.touches_boundary
+			|| run.global_x == 0 || run.global_x == map_width - 1
+			|| run.global_y_begin == 0 || run.global_y_end == map_width;
+	}
+
+	// Phase 4: group runs by component
+	std::uint32_t offset = 0;
+	for (TileComponent &component : labels.components) {
+		component.run_offset = offset;
+		offset += component.run_count;
+	}
+
+	std::vector<std::uint32_t> cursor(labels.components.size());
+	labels.runs.resize(runs.size());
+	for (std::uint32_t i = 0; i < runs.size(); ++i) {
+		const std::uint32_t id = component_of[i];
+		const TileComponent &component = labels.components[id];
+		labels.runs[component.run_offset + cursor[id]++] = runs[i];
+	}
+
+	return labels;
+}
+
+ComponentLabels label_components(
+	const TileMap &tilemap, const TileMask &mask, bool chebyshev
+) {
+	WorkerPool pool(1);
+	return label_components(tilemap, mask, chebyshev, pool);
+}
+
+} // namespace istd
@@ -1,20 +1,180 @@
 #include "tilemap/generation.h"
+#include "tilemap/pass/base_tile_type.h"
+#include "tilemap/pass/biome.h"
+#include "tilemap/pass/coal.h"
+#include "tilemap/pass/deepwater.h"
+#include "tilemap/pass/mineral_cluster.h"
+#include "tilemap/pass/mountain_hole_fill.h"
+#include "tilemap/pass/oil.h"
+#include "tilemap/pass/smoothen_island.h"
+#include "tilemap/pass/smoothen_mountain.h"
 
 namespace istd {
+
+namespace {
+
+// The resource passes place deposits with their first RNG stream rather than
+// with world-space noise. Windows of a LazyTileMap reseed that stream from
+// their origin, or every window would repeat the same layout. Maps at origin
+// 0 keep the stream as handed out.
+Xoroshiro128PP placement_rng(const PassContext &ctx, const TileMap &tilemap) {
+	Xoroshiro128PP rng = ctx.rngs[0];
+	const ChunkCoord origin_x = tilemap.origin_x();
+	const ChunkCoord origin_y = tilemap.origin_y();
+	if (origin_x == 0 && origin_y == 0) {
+		return rng;
+	}
+	const std::uint64_t s0 = rng.next();
+	const std::uint64_t s1 = rng.next();
+	return Seed{
+		StableHasher().add(s0, origin_x, origin_y).value(),
+		StableHasher().add(s1, origin_y, origin_x).value(),
+	};
+}
+
+} // namespace
+
+GenerationPipeline default_pipeline() {
+	GenerationPipeline pipeline;
+
+	// The config fields hashed for each pass must cover everything the pass
+	// reads, or snapshots go stale. threads never changes the output.
+
+	// Temperature and humidity noise
+	pipeline.add_pass(
+		"biome", 2,
+		[](TileMap &tilemap, const PassContext &ctx) {
+			BiomeGenerationPass pass(ctx.config, ctx.rngs[0], ctx.rngs[1]);
+			pass(tilemap, ctx.pool);
+		},
+		[](StableHasher &hasher, const GenerationConfig &config) {
+			hasher.add(
+				config.temperature_scale, config.temperature_octaves,
+				config.temperature_persistence, config.humidity_scale,
+				config.humidity_octaves, config.humidity_persistence,
+				config.noise_quantile_buckets
+			);
+		}
+	);
+	pipeline.add_pass(
+		"base_tile_type", 1,
+		[](TileMap &tilemap, const PassContext &ctx) {
+			BaseTileTypeGenerationPass pass(ctx.config, ctx.rngs[0]);
+			pass(tilemap, ctx.pool);
+		},
+		[](StableHasher &hasher, const GenerationConfig &config) {
+			hasher.add(
+				config.base_scale, config.base_octaves, config.base_persistence,
+				config.noise_quantile_buckets
+			);
+		}
+	);
+	pipeline.add_pass(
+		"smoothen_mountains", 1,
+		[](TileMap &tilemap, const PassContext &ctx) {
+			SmoothenMountainsPass pass(ctx.config, ctx.rngs[0]);
+			pass(tilemap, ctx.pool);
+		},
+		[](StableHasher &hasher, const GenerationConfig &config) {
+			hasher.add(
+				config.noise_backend, config.mountain_smoothen_steps,
+				config.mountain_remove_threshold
+			);
+		}
+	);
+	pipeline.add_pass(
+		"smoothen_islands", 1,
+		[](TileMap &tilemap, const PassContext &ctx) {
+			SmoothenIslandPass pass(ctx.config, ctx.rngs[0]);
+			pass(tilemap, ctx.pool);
+		},
+		[](StableHasher &hasher, const GenerationConfig &config) {
+			hasher.add(
+				config.noise_backend, config.island_smoothen_steps,
+				config.island_remove_threshold
+			);
+		}
+	);
+	pipeline.add_pass(
+		"mountain_hole_fill", 0,
+		[](TileMap &tilemap, const PassContext &ctx) {
+			MountainHoleFillPass pass(ctx.config);
+			pass(tilemap, ctx.pool);
+		},
+		[](StableHasher &hasher, const GenerationConfig &config) {
+			hasher.add(config.fill_threshold);
+		}
+	);
+	pipeline.add_pass(
+		"deepwater", 0,
+		[](TileMap &tilemap, const PassContext &ctx) {
+			DeepwaterGenerationPass pass(ctx.config.deepwater_radius);
+			pass(tilemap);
+		},
+		[](StableHasher &hasher, const GenerationConfig &config) {
+			hasher.add(config.deepwater_radius);
+		}
+	);
+
+	// The resource passes own a placement RNG and a noise RNG, see
+	// placement_rng()
+	pipeline.add_pass(
+		"oil", 2,
+		[](TileMap &tilemap, const PassContext &ctx) {
+			OilGenerationPass pass(
+				ctx.config, placement_rng(ctx, tilemap), ctx.rngs[1]
+			);
+			pass(tilemap);
+		},
+		[](StableHasher &hasher, const GenerationConfig &config) {
+			hasher.add(
+				config.noise_backend, config.oil_density,
+				config.oil_cluster_min_size, config.oil_cluster_max_size,
+				config.oil_base_probe
+			);
+		}
+	);
+	pipeline.add_pass(
+		"mineral_cluster", 2,
+		[](TileMap &tilemap, const PassContext &ctx) {
+			MineralClusterGenerationPass pass(
+				ctx.config, placement_rng(ctx, tilemap), ctx.rngs[1]
+			);
+			pass(tilemap);
+		},
+		[](StableHasher &hasher, const GenerationConfig &config) {
+			hasher.add(
+				config.noise_backend, config.hematite_density,
+				config.titanomagnetite_density, config.gibbsite_density,
+				config.mineral_cluster_min_size,
+				config.mineral_cluster_max_size, config.mineral_base_prob
+			);
+		}
+	);
+	pipeline.add_pass(
+		"coal", 2,
+		[](TileMap &tilemap, const PassContext &ctx) {
+			CoalGenerationPass pass(
+				ctx.config, placement_rng(ctx, tilemap), ctx.rngs[1]
+			);
+			pass(tilemap);
+		},
+		[](StableHasher &hasher, const GenerationConfig &config) {
+			hasher.add(
+				config.noise_backend, config.coal_seeds_per_chunk,
+				config.coal_evolution_steps, config.coal_growth_base_prob
+			);
+		}
+	);
+
+	return pipeline;
+}
+
 TerrainGenerator::TerrainGenerator(const GenerationConfig &config)
-	: config_(config) {}
+	: config_(config), pool_(config.threads), pipeline_(default_pipeline()) {}
 
 void TerrainGenerator::operator()(TileMap &tilemap) {
-	master_rng_ = Xoroshiro128PP(config_.seed);
-	biome_pass(tilemap);
-	base_tile_type_pass(tilemap);
-	smoothen_mountains_pass(tilemap);
-	smoothen_islands_pass(tilemap);
-	mountain_hole_fill_pass(tilemap);
-	deepwater_pass(tilemap);
-	oil_pass(tilemap);
-	mineral_cluster_pass(tilemap);
-	coal_pass(tilemap);
+	report_ = pipeline_.run(tilemap, config_, pool_, snapshots_);
 }
 
 void map_generate(TileMap &tilemap, const GenerationConfig &config) {
@@ -0,0 +1,86 @@
+#include "tilemap/generation_cache.h"
+#include "tilemap/map_file.h"
+#include <format>
+#include <stdexcept>
+#include <system_error>
+
+namespace istd {
+
+GenerationCache::GenerationCache(std::filesystem::path directory)
+	: directory_(std::move(directory)) {
+	std::filesystem::create_directories(directory_);
+}
+
+std::filesystem::path GenerationCache::entry_path(std::uint64_t key) const {
+	return directory_ / std::format("{:016x}.tilemap", key);
+}
+
+std::uint64_t GenerationCache::key(
+	const GenerationConfig &config, ChunkCoord map_size, ChunkCoord origin_x,
+	ChunkCoord origin_y
+) {
+	const auto stage_keys = default_pipeline().stage_keys(
+		config, map_size, origin_x, origin_y
+	);
+	return StableHasher().add(generator_version, stage_keys.back()).value();
+}
+
+bool GenerationCache::load(std::uint64_t key, TileMap &tilemap) const {
+	const auto path = entry_path(key);
+	if (!std::filesystem::exists(path)) {
+		return false;
+	}
+
+	try {
+		TileMapReader reader(path);
+		if (reader.user_key() != key
+		    || reader.map_size() != tilemap.get_size()) {
+			return false;
+		}
+		reader.read_all(tilemap);
+	} catch (const std::runtime_error &) {
+		// Unreadable or corrupt entry, regenerate and overwrite it
+		return false;
+	}
+	return true;
+}
+
+bool GenerationCache::store(std::uint64_t key, const TileMap &tilemap) const {
+	const auto path = entry_path(key);
+	auto temp_path = path;
+	temp_path += ".tmp";
+
+	std::error_code ec;
+	try {
+		save_tilemap(temp_path, tilemap, key);
+	} catch (const std::runtime_error &) {
+		std::filesystem::remove(temp_path, ec);
+		return false;
+	}
+
+	// Renaming over an existing entry is atomic
+	std::filesystem::rename(temp_path, path, ec);
+	if (ec) {
+		std::filesystem::remove(temp_path, ec);
+		return false;
+	}
+	return true;
+}
+
+bool map_generate(
+	TileMap &tilemap, const GenerationConfig &config,
+	const GenerationCache &cache
+) {
+	const std::uint64_t key = GenerationCache::key(
+		config, tilemap.get_size(), tilemap.origin_x(), tilemap.origin_y()
+	);
+	if (cache.load(key, tilemap)) {
+		return true;
+	}
+
+	map_generate(tilemap, config);
+	cache.store(key, tilemap);
+	return false;
+}
+
+} // namespace istd
@@ -0,0 +1,116 @@
+#include "tilemap/lazy_tilemap.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace istd {
+
+namespace {
+
+// First chunk of the window generated for a region along one axis: the
+// region extended by the halo on both sides, shifted to stay inside the map
+ChunkCoord window_begin(
+	ChunkCoord region_begin, ChunkCoord halo, ChunkCoord window_size,
+	ChunkCoord map_size
+) {
+	const ChunkCoord begin = region_begin - std::min(region_begin, halo);
+	return std::min<ChunkCoord>(begin, map_size - window_size);
+}
+
+} // namespace
+
+LazyTileMap::LazyTileMap(
+	ChunkCoord size, const GenerationConfig &config, ChunkCoord region_size,
+	ChunkCoord halo
+)
+	: config_(config)
+	, pool_(config.threads)
+	, pipeline_(default_pipeline())
+	, tilemap_(size, ChunkAllocation::OnDemand)
+	, region_size_(region_size)
+	, halo_(halo) {
+	if (region_size == 0) {
+		throw std::invalid_argument("Region size must be at least 1");
+	}
+}
+
+void LazyTileMap::generate_region(ChunkCoord chunk_x, ChunkCoord chunk_y) {
+	const ChunkCoord map_size = tilemap_.get_size();
+	const ChunkCoord region_x = chunk_x - chunk_x % region_size_;
+	const ChunkCoord region_y = chunk_y - chunk_y % region_size_;
+	const ChunkCoord window_size = std::min<std::uint32_t>(
+		region_size_ + 2u * halo_, map_size
+	);
+	const ChunkCoord window_x = window_begin(
+		region_x, halo_, window_size, map_size
+	);
+	const ChunkCoord window_y = window_begin(
+		region_y, halo_, window_size, map_size
+	);
+
+	TileMap window(window_size);
+	window.set_origin(window_x, window_y);
+	report_ = pipeline_.run(window, config_, pool_);
+
+	const ChunkCoord x_end = std::min<std::uint32_t>(
+		region_x + region_size_, map_size
+	);
+	const ChunkCoord y_end = std::min<std::uint32_t>(
+		region_y + region_size_, map_size
+	);
+	for (ChunkCoord x = region_x; x < x_end; ++x) {
+		for (ChunkCoord y = region_y; y < y_end; ++y) {
+			tilemap_.get_chunk_unchecked(x, y) = window.get_chunk_unchecked(
+				x - window_x, y - window_y
+			);
+		}
+	}
+	++generated_regions_;
+}
+
+bool LazyTileMap::is_generated(ChunkCoord chunk_x, ChunkCoord chunk_y) const {
+	return tilemap_.has_chunk(chunk_x, chunk_y);
+}
+
+Chunk &LazyTileMap::get_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y) {
+	if (!is_generated(chunk_x, chunk_y)) {
+		generate_region(chunk_x, chunk_y);
+	}
+	return tilemap_.get_chunk_unchecked(chunk_x, chunk_y);
+}
+
+Tile &LazyTileMap::get_tile(TilePos pos) {
+	if (pos.local_x >= Chunk::size || pos.local_y >= Chunk::size) {
+		throw std::out_of_range("Local coordinates out of bounds");
+	}
+	return get_chunk(pos.chunk_x, pos.chunk_y).tiles[pos.local_x][pos.local_y];
+}
+
+void LazyTileMap::set_tile(TilePos pos, const Tile &tile) {
+	get_tile(pos) = tile;
+}
+
+void LazyTileMap::generate_area(
+	ChunkCoord chunk_x, ChunkCoord chunk_y, ChunkCoord width, ChunkCoord height
+) {
+	const ChunkCoord map_size = tilemap_.get_size();
+	if (chunk_x >= map_size || chunk_y >= map_size) {
+		throw std::out_of_range("Chunk coordinates out of bounds");
+	}
+	const ChunkCoord x_end = std::min<std::uint32_t>(chunk_x + width, map_size);
+	const ChunkCoord y_end = std::min<std::uint32_t>(
+		chunk_y + height, map_size
+	);
+
+	// Visit one chunk per region
+	for (std::uint32_t x = chunk_x - chunk_x % region_size_; x < x_end;
+	     x += region_size_) {
+		for (std::uint32_t y = chunk_y - chunk_y % region_size_; y < y_end;
+		     y += region_size_) {
+			if (!is_region_generated(x, y)) {
+				generate_region(x, y);
+			}
+		}
+	}
+}
+
+} // namespace istd
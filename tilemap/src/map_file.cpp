@@ -0,0 +1,550 @@
+#include "tilemap/map_file.h"
+#include "tilemap/biome.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace istd {
+
+namespace map_file {
+
+namespace {
+
+// Slicing-by-8 tables: crc_table[0] is the classic byte table, and
+// crc_table[k][i] is the CRC of byte i followed by k zero bytes
+constexpr std::array<std::array<std::uint32_t, 256>, 8> make_crc_table() {
+	std::array<std::array<std::uint32_t, 256>, 8> table{};
+	for (std::uint32_t i = 0; i < 256; ++i) {
+		std::uint32_t crc = i;
+		for (int bit = 0; bit < 8; ++bit) {
+			crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320 : 0);
+		}
+		table[0][i] = crc;
+	}
+	for (std::size_t k = 1; k < table.size(); ++k) {
+		for (std::uint32_t i = 0; i < 256; ++i) {
+			const std::uint32_t prev = table[k - 1][i];
+			table[k][i] = (prev >> 8) ^ table[0][prev & 0xFF];
+		}
+	}
+	return table;
+}
+
+constexpr auto crc_table = make_crc_table();
+
+} // namespace
+
+std::uint32_t crc32(std::span<const std::uint8_t> data) noexcept {
+	std::uint32_t crc = 0xFFFFFFFF;
+	const std::uint8_t *in = data.data();
+	std::size_t size = data.size();
+	// Fold 8 bytes per step, the first 4 of them into the running CRC
+	for (; size >= 8; size -= 8, in += 8) {
+		const std::uint32_t low = crc ^ in[0] ^ in[1] << 8 ^ in[2] << 16
+			^ static_cast<std::uint32_t>(in[3]) << 24;
+		crc = crc_table[7][low & 0xFF] ^ crc_table[6][(low >> 8) & 0xFF]
+			^ crc_table[5][(low >> 16) & 0xFF] ^ crc_table[4][low >> 24]
+			^ crc_table[3][in[4]] ^ crc_table[2][in[5]]
+			^ crc_table[1][in[6]] ^ crc_table[0][in[7]];
+	}
+	for (; size > 0; --size) {
+		crc = (crc >> 8) ^ crc_table[0][(crc ^ *in++) & 0xFF];
+	}
+	return ~crc;
+}
+
+} // namespace map_file
+
+namespace {
+
+using namespace map_file;
+
+void store_le(std::uint8_t *dest, std::uint64_t value, int bytes) {
+	for (int i = 0; i < bytes; ++i) {
+		dest[i] = static_cast<std::uint8_t>(value >> (i * 8));
+	}
+}
+
+std::uint64_t load_le(const std::uint8_t *src, int bytes) {
+	std::uint64_t value = 0;
+	for (int i = 0; i < bytes; ++i) {
+		value |= static_cast<std::uint64_t>(src[i]) << (i * 8);
+	}
+	return value;
+}
+
+std::uint8_t tile_byte(Tile tile) {
+	return static_cast<std::uint8_t>(tile.base)
+		| static_cast<std::uint8_t>(tile.surface) << 4;
+}
+
+Tile byte_tile(std::uint8_t byte) {
+	Tile tile;
+	tile.base = static_cast<BaseTileType>(byte & 0xF);
+	tile.surface = static_cast<SurfaceTileType>(byte >> 4);
+	return tile;
+}
+
+// Raw records are read and mapped as Chunk objects, which requires Tile to
+// pack base into the low nibble. The probe needs distinct nibbles to tell
+// the two orders apart.
+constexpr Tile layout_probe{BaseTileType::Sand, SurfaceTileType::Oil};
+static_assert(
+	std::bit_cast<std::uint8_t>(layout_probe) == 0x12,
+	"Tile must store base in the low nibble and surface in the high nibble"
+);
+static_assert(
+	sizeof(Chunk) == raw_record_size, "Chunk must match the raw record layout"
+);
+
+std::size_t encode_chunk(const Chunk &chunk, std::uint8_t *record) {
+	std::uint8_t *out = record;
+	for (const auto &row : chunk.tiles) {
+		for (Tile tile : row) {
+			*out++ = tile_byte(tile);
+		}
+	}
+	for (const auto &row : chunk.biome) {
+		for (BiomeType biome : row) {
+			*out++ = static_cast<std::uint8_t>(biome);
+		}
+	}
+	return out - record;
+}
+
+std::size_t encode_chunk(const CompactChunk &chunk, std::uint8_t *record) {
+	std::uint8_t *out = record;
+	*out++ = chunk.palette().size();
+	for (Tile tile : chunk.palette()) {
+		*out++ = tile_byte(tile);
+	}
+	for (std::uint64_t word : chunk.packed_indices()) {
+		store_le(out, word, 8);
+		out += 8;
+	}
+	for (std::uint8_t x = 0; x < Chunk::subchunk_count; ++x) {
+		for (std::uint8_t y = 0; y < Chunk::subchunk_count; ++y) {
+			*out++ = static_cast<std::uint8_t>(chunk.get_biome({x, y}));
+		}
+	}
+	return out - record;
+}
+
+CompactChunk decode_palette_chunk(
+	const IndexEntry &entry, const std::uint8_t *record
+) {
+	const std::size_t palette_size = record[0];
+	const std::size_t words = CompactChunk::tile_count
+		* CompactChunk::index_bits(palette_size) / 64;
+	if (palette_size == 0 || palette_size > CompactChunk::max_palette_size
+	    || entry.size
+	           != 1 + palette_size + words * 8 + CompactChunk::biome_count) {
+		throw std::runtime_error("Invalid tilemap palette chunk");
+	}
+
+	std::array<Tile, CompactChunk::max_palette_size> palette;
+	for (std::size_t i = 0; i < palette_size; ++i) {
+		palette[i] = byte_tile(record[1 + i]);
+	}
+	const std::uint8_t *in = record + 1 + palette_size;
+	std::array<std::uint64_t, CompactChunk::tile_count * 4 / 64> indices;
+	for (std::size_t i = 0; i < words; ++i) {
+		indices[i] = load_le(in, 8);
+		in += 8;
+	}
+	std::array<BiomeType, CompactChunk::biome_count> biomes;
+	for (BiomeType &biome : biomes) {
+		biome = static_cast<BiomeType>(*in++);
+	}
+	return CompactChunk(
+		{palette.data(), palette_size}, {indices.data(), words}, biomes
+	);
+}
+
+void decode_chunk(
+	const IndexEntry &entry, const std::uint8_t *record, Chunk &chunk
+) {
+	if (entry.encoding == ChunkEncoding::Palette) {
+		decode_palette_chunk(entry, record).decompress(chunk);
+		return;
+	}
+	if (entry.encoding != ChunkEncoding::Raw
+	    || entry.size != raw_record_size) {
+		throw std::runtime_error("Unsupported tilemap chunk encoding");
+	}
+	std::memcpy(&chunk, record, raw_record_size);
+}
+
+} // namespace
+
+TileMapWriter::TileMapWriter(
+	const std::filesystem::path &path, ChunkCoord map_size,
+	std::uint64_t user_key
+)
+	: file_(path, std::ios::binary | std::ios::trunc)
+	, map_size_(map_size)
+	, index_(static_cast<std::size_t>(map_size) * map_size) {
+	if (!file_.is_open()) {
+		throw std::runtime_error(
+			"Cannot open tilemap file for writing: " + path.string()
+		);
+	}
+
+	const std::uint64_t index_offset = header_size;
+	next_offset_ = index_offset + index_.size() * index_entry_size;
+
+	std::array<std::uint8_t, header_size> header{};
+	std::copy(magic.begin(), magic.end(), header.begin());
+	store_le(&header[8], version, 4);
+	store_le(&header[12], Chunk::size, 4);
+	store_le(&header[16], map_size, 4);
+	store_le(&header[20], index_.size(), 4);
+	store_le(&header[24], user_key, 8);
+	store_le(&header[32], index_offset, 8);
+	store_le(&header[40], next_offset_, 8);
+	file_.write(reinterpret_cast<const char *>(header.data()), header.size());
+
+	// Reserve the index, it is filled in by finish()
+	const std::vector<char> empty_index(index_.size() * index_entry_size);
+	file_.write(empty_index.data(), empty_index.size());
+	if (!file_) {
+		throw std::runtime_error("Cannot write tilemap file header");
+	}
+}
+
+void TileMapWriter::append_record(
+	ChunkCoord chunk_x, ChunkCoord chunk_y, std::size_t size,
+	ChunkEncoding encoding
+) {
+	IndexEntry &entry = index_[std::size_t(chunk_x) * map_size_ + chunk_y];
+	file_.write(reinterpret_cast<const char *>(record_.data()), size);
+	if (!file_) {
+		throw std::runtime_error("Cannot write tilemap chunk");
+	}
+
+	entry.offset = next_offset_;
+	entry.size = size;
+	entry.checksum = crc32({record_.data(), size});
+	entry.encoding = encoding;
+	next_offset_ += size;
+}
+
+void TileMapWriter::write_chunk(
+	ChunkCoord chunk_x, ChunkCoord chunk_y, const Chunk &chunk
+) {
+	if (chunk_x >= map_size_ || chunk_y >= map_size_) {
+		throw std::out_of_range("Chunk coordinates out of bounds");
+	}
+	const std::size_t index = std::size_t(chunk_x) * map_size_ + chunk_y;
+	if (finished_ || index_[index].offset != 0) {
+		throw std::logic_error("Chunk written twice or after finish()");
+	}
+
+	const std::size_t size = encode_chunk(chunk, record_.data());
+	append_record(chunk_x, chunk_y, size, ChunkEncoding::Raw);
+}
+
+void TileMapWriter::write_chunk(
+	ChunkCoord chunk_x, ChunkCoord chunk_y, const CompactChunk &chunk
+) {
+	if (chunk.is_expanded()) {
+		Chunk full;
+		chunk.decompress(full);
+		write_chunk(chunk_x, chunk_y, full);
+		return;
+	}
+	if (chunk_x >= map_size_ || chunk_y >= map_size_) {
+		throw std::out_of_range("Chunk coordinates out of bounds");
+	}
+	const std::size_t index = std::size_t(chunk_x) * map_size_ + chunk_y;
+	if (finished_ || index_[index].offset != 0) {
+		throw std::logic_error("Chunk written twice or after finish()");
+	}
+
+	const std::size_t size = encode_chunk(chunk, record_.data());
+	append_record(chunk_x, chunk_y, size, ChunkEncoding::Palette);
+}
+
+void TileMapWriter::finish() {
+	if (finished_) {
+		return;
+	}
+
+	std::vector<std::uint8_t> index(index_.size() * index_entry_size);
+	for (std::size_t i = 0; i < index_.size(); ++i) {
+		std::uint8_t *dest = &index[i * index_entry_size];
+		store_le(dest, index_[i].offset, 8);
+		store_le(dest + 8, index_[i].size, 4);
+		store_le(dest + 12, index_[i].checksum, 4);
+		dest[16] = static_cast<std::uint8_t>(index_[i].encoding);
+	}
+	file_.seekp(header_size);
+	file_.write(reinterpret_cast<const char *>(index.data()), index.size());
+	file_.flush();
+	if (!file_) {
+		throw std::runtime_error("Cannot write tilemap chunk index");
+	}
+	finished_ = true;
+}
+
+TileMapReader::TileMapReader(const std::filesystem::path &path)
+	: file_(path, std::ios::binary) {
+	if (!file_.is_open()) {
+		throw std::runtime_error("Cannot open tilemap file: " + path.string());
+	}
+
+	std::array<std::uint8_t, header_size> header;
+	file_.read(reinterpret_cast<char *>(header.data()), header.size());
+	if (!file_ || !std::equal(magic.begin(), magic.end(), header.begin())) {
+		throw std::runtime_error("Not a tilemap file: " + path.string());
+	}
+	if (load_le(&header[8], 4) != version) {
+		throw std::runtime_error("Unsupported tilemap file version");
+	}
+
+	const std::uint64_t chunk_side = load_le(&header[12], 4);
+	const std::uint64_t map_size = load_le(&header[16], 4);
+	const std::uint64_t chunk_count = load_le(&header[20], 4);
+	if (chunk_side != Chunk::size || map_size == 0
+	    || map_size > TileMap::max_size || chunk_count != map_size * map_size) {
+		throw std::runtime_error("Invalid tilemap file header");
+	}
+	map_size_ = map_size;
+	user_key_ = load_le(&header[24], 8);
+	data_offset_ = load_le(&header[40], 8);
+
+	std::vector<std::uint8_t> index(chunk_count * index_entry_size);
+	file_.seekg(load_le(&header[32], 8));
+	file_.read(reinterpret_cast<char *>(index.data()), index.size());
+	if (!file_) {
+		throw std::runtime_error("Cannot read tilemap chunk index");
+	}
+
+	index_.resize(chunk_count);
+	for (std::size_t i = 0; i < index_.size(); ++i) {
+		const std::uint8_t *src = &index[i * index_entry_size];
+		index_[i].offset = load_le(src, 8);
+		index_[i].size = load_le(src + 8, 4);
+		index_[i].checksum = load_le(src + 12, 4);
+		index_[i].encoding = static_cast<ChunkEncoding>(src[16]);
+	}
+}
+
+const IndexEntry &TileMapReader::entry(
+	ChunkCoord chunk_x, ChunkCoord chunk_y
+) const {
+	if (chunk_x >= map_size_ || chunk_y >= map_size_) {
+		throw std::out_of_range("Chunk coordinates out of bounds");
+	}
+	return index_[std::size_t(chunk_x) * map_size_ + chunk_y];
+}
+
+bool TileMapReader::is_contiguous() const noexcept {
+	for (std::size_t i = 0; i < index_.size(); ++i) {
+		if (index_[i].encoding != ChunkEncoding::Raw
+		    || index_[i].size != raw_record_size
+		    || index_[i].offset != data_offset_ + i * raw_record_size) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool TileMapReader::has_chunk(
+	ChunkCoord chunk_x, ChunkCoord chunk_y
+) const {
+	return entry(chunk_x, chunk_y).offset != 0;
+}
+
+const IndexEntry &TileMapReader::read_record(
+	ChunkCoord chunk_x, ChunkCoord chunk_y
+) {
+	const IndexEntry &chunk_entry = entry(chunk_x, chunk_y);
+	if (chunk_entry.offset == 0) {
+		throw std::runtime_error("Chunk is missing from tilemap file");
+	}
+	if (chunk_entry.size > record_.size()) {
+		throw std::runtime_error("Invalid tilemap chunk size");
+	}
+
+	file_.seekg(chunk_entry.offset);
+	file_.read(reinterpret_cast<char *>(record_.data()), chunk_entry.size);
+	if (!file_) {
+		file_.clear();
+		throw std::runtime_error("Cannot read tilemap chunk");
+	}
+	if (crc32({record_.data(), chunk_entry.size}) != chunk_entry.checksum) {
+		throw std::runtime_error("Tilemap chunk checksum mismatch");
+	}
+	return chunk_entry;
+}
+
+void TileMapReader::read_chunk(
+	ChunkCoord chunk_x, ChunkCoord chunk_y, Chunk &chunk
+) {
+	decode_chunk(read_record(chunk_x, chunk_y), record_.data(), chunk);
+}
+
+void TileMapReader::read_chunk(
+	ChunkCoord chunk_x, ChunkCoord chunk_y, CompactChunk &chunk
+) {
+	const IndexEntry &chunk_entry = read_record(chunk_x, chunk_y);
+	if (chunk_entry.encoding == ChunkEncoding::Palette) {
+		chunk = decode_palette_chunk(chunk_entry, record_.data());
+		return;
+	}
+	Chunk full;
+	decode_chunk(chunk_entry, record_.data(), full);
+	chunk = CompactChunk(full);
+}
+
+void TileMapReader::read_all(TileMap &tilemap) {
+	if (tilemap.get_size() != map_size_) {
+		throw std::invalid_argument("Tilemap size does not match the file");
+	}
+
+	// Raw records stored back to back are the chunk array of an eager map,
+	// read them in one sweep and verify them in place
+	const auto chunks = tilemap.chunks();
+	if (!chunks.empty() && is_contiguous()) {
+		file_.seekg(data_offset_);
+		file_.read(
+			reinterpret_cast<char *>(chunks.data()), chunks.size_bytes()
+		);
+		if (!file_) {
+			file_.clear();
+			throw std::runtime_error("Cannot read tilemap chunks");
+		}
+		for (std::size_t i = 0; i < chunks.size(); ++i) {
+			const auto *data = reinterpret_cast<const std::uint8_t *>(
+				&chunks[i]
+			);
+			if (crc32({data, sizeof(Chunk)}) != index_[i].checksum) {
+				throw std::runtime_error("Tilemap chunk checksum mismatch");
+			}
+		}
+		return;
+	}
+
+	// Read in file order, which is the order the chunks were written in
+	std::vector<std::uint32_t> order(index_.size());
+	for (std::uint32_t i = 0; i < order.size(); ++i) {
+		order[i] = i;
+	}
+	std::ranges::sort(order, {}, [this](std::uint32_t i) {
+		return index_[i].offset;
+	});
+	for (std::uint32_t i : order) {
+		const ChunkCoord chunk_x = i / map_size_;
+		const ChunkCoord chunk_y = i % map_size_;
+		read_chunk(
+			chunk_x, chunk_y, tilemap.get_chunk_unchecked(chunk_x, chunk_y)
+		);
+	}
+}
+
+void save_tilemap(
+	const std::filesystem::path &path, const TileMap &tilemap,
+	std::uint64_t user_key
+) {
+	const ChunkCoord map_size = tilemap.get_size();
+	TileMapWriter writer(path, map_size, user_key);
+	for (ChunkCoord chunk_x = 0; chunk_x < map_size; ++chunk_x) {
+		for (ChunkCoord chunk_y = 0; chunk_y < map_size; ++chunk_y) {
+			writer.write_chunk(
+				chunk_x, chunk_y, tilemap.get_chunk_unchecked(chunk_x, chunk_y)
+			);
+		}
+	}
+	writer.finish();
+}
+
+void save_tilemap(
+	const std::filesystem::path &path, const CompactTileMap &tilemap,
+	std::uint64_t user_key
+) {
+	const ChunkCoord map_size = tilemap.get_size();
+	TileMapWriter writer(path, map_size, user_key);
+	for (ChunkCoord chunk_x = 0; chunk_x < map_size; ++chunk_x) {
+		for (ChunkCoord chunk_y = 0; chunk_y < map_size; ++chunk_y) {
+			writer.write_chunk(
+				chunk_x, chunk_y, tilemap.get_chunk(chunk_x, chunk_y)
+			);
+		}
+	}
+	writer.finish();
+}
+
+TileMap load_tilemap(const std::filesystem::path &path) {
+	TileMapReader reader(path);
+	TileMap tilemap(reader.map_size());
+	reader.read_all(tilemap);
+	return tilemap;
+}
+
+CompactTileMap load_compact_tilemap(const std::filesystem::path &path) {
+	TileMapReader reader(path);
+	CompactTileMap tilemap(reader.map_size());
+	for (ChunkCoord chunk_x = 0; chunk_x < reader.map_size(); ++chunk_x) {
+		for (ChunkCoord chunk_y = 0; chunk_y < reader.map_size(); ++chunk_y) {
+			reader.read_chunk(
+				chunk_x, chunk_y, tilemap.get_chunk(chunk_x, chunk_y)
+			);
+		}
+	}
+	return tilemap;
+}
+
+TileMap map_tilemap(
+	const std::filesystem::path &path, MapMode mode, bool verify
+) {
+	TileMapReader reader(path);
+	if (!reader.is_contiguous()) {
+		throw std::runtime_error(
+			"Tilemap file is not contiguous and cannot be mapped"
+		);
+	}
+
+	if (verify) {
+		Chunk chunk;
+		for (ChunkCoord chunk_x = 0; chunk_x < reader.map_size(); ++chunk_x) {
+			for (ChunkCoord chunk_y = 0; chunk_y < reader.map_size();
+			     ++chunk_y) {
+				reader.read_chunk(chunk_x, chunk_y, chunk);
+			}
+		}
+	}
+
+	auto mapping = std::make_shared<MappedFile>(path, mode);
+	const std::size_t chunk_count = std::size_t(reader.map_size())
+		* reader.map_size();
+	if (mapping->bytes().size()
+	    < reader.data_offset() + chunk_count * raw_record_size) {
+		throw std::runtime_error("Tilemap file is truncated");
+	}
+	return TileMap(reader.map_size(), std::move(mapping), reader.data_offset());
+}
+
+void sync_tilemap(TileMap &tilemap) {
+	const auto &mapping = tilemap.mapping();
+	if (!mapping || mapping->mode() != MapMode::WriteThrough) {
+		throw std::logic_error("Tilemap is not mapped write-through");
+	}
+
+	// The header was validated by map_tilemap()
+	const auto bytes = mapping->bytes();
+	const std::uint64_t index_offset = load_le(&bytes[32], 8);
+	const auto chunks = tilemap.chunks();
+	for (std::size_t i = 0; i < chunks.size(); ++i) {
+		const auto *data = reinterpret_cast<const std::uint8_t *>(&chunks[i]);
+		store_le(
+			&bytes[index_offset + i * index_entry_size + 12],
+			crc32({data, sizeof(Chunk)}), 4
+		);
+	}
+	mapping->sync();
+}
+
+} // namespace istd
@@ -0,0 +1,74 @@
+#include "tilemap/mapped_file.h"
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ISTD_TILEMAP_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace istd {
+
+#ifdef ISTD_TILEMAP_HAS_MMAP
+
+MappedFile::MappedFile(const std::filesystem::path &path, MapMode mode)
+	: mode_(mode) {
+	const bool shared = mode == MapMode::WriteThrough;
+	const int fd = ::open(path.c_str(), shared ? O_RDWR : O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error("Cannot open file to map: " + path.string());
+	}
+
+	struct stat info;
+	if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+		::close(fd);
+		throw std::runtime_error("Cannot map empty file: " + path.string());
+	}
+	size_ = info.st_size;
+
+	// A private mapping may be writable even though the file is read-only
+	void *data = ::mmap(
+		nullptr, size_, PROT_READ | PROT_WRITE,
+		shared ? MAP_SHARED : MAP_PRIVATE, fd, 0
+	);
+	// The mapping keeps its own reference to the file
+	::close(fd);
+	if (data == MAP_FAILED) {
+		throw std::runtime_error("Cannot map file: " + path.string());
+	}
+	data_ = static_cast<std::uint8_t *>(data);
+}
+
+MappedFile::~MappedFile() {
+	::munmap(data_, size_);
+}
+
+void MappedFile::sync() {
+	if (mode_ != MapMode::WriteThrough) {
+		throw std::logic_error("Copy-on-write mappings cannot be synced");
+	}
+	if (::msync(data_, size_, MS_SYNC) != 0) {
+		throw std::runtime_error("Cannot write mapped file back");
+	}
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path &path, MapMode mode)
+	: mode_(mode) {
+	throw std::runtime_error(
+		"Memory-mapped files are not supported on this platform: "
+		+ path.string()
+	);
+}
+
+MappedFile::~MappedFile() = default;
+
+void MappedFile::sync() {}
+
+#endif
+
+} // namespace istd
@@ -8,8 +8,15 @@
 
 namespace istd {
 
-DiscreteRandomNoise::DiscreteRandomNoise(Xoroshiro128PP rng) noexcept {
+DiscreteRandomNoise::DiscreteRandomNoise(
+	Xoroshiro128PP rng, NoiseBackend backend
+) noexcept
+	: backend_(backend) {
 	mask = rng.next();
+	if (backend_ == NoiseBackend::MultiplyXorshift) {
+		key_ = rng.next();
+		return;
+	}
 	std::iota(permutation_.begin(), permutation_.end(), 0);
 	std::shuffle(permutation_.begin(), permutation_.end(), rng);
 }
@@ -44,9 +51,29 @@ std::uint32_t DiscreteRandomNoise::map(std::uint32_t x) const noexcept {
 	return x;
 }
 
+std::uint64_t DiscreteRandomNoise::mix_noise(
+	std::uint32_t x, std::uint32_t y, std::uint32_t z
+) const noexcept {
+	// splitmix64 finalizer, a bijection on 64-bit words
+	auto mix = [](std::uint64_t v) {
+		v = (v ^ (v >> 30)) * 0xBF58476D1CE4E5B9;
+		v = (v ^ (v >> 27)) * 0x94D049BB133111EB;
+		return v ^ (v >> 31);
+	};
+
+	// Distinct (x, y) give distinct inner values, and for fixed (x, y) the
+	// outer round maps distinct z to distinct outputs
+	std::uint64_t xy = (static_cast<std::uint64_t>(x) << 32) | y;
+	return mix(mix(xy ^ mask) ^ (z + key_));
+}
+
 std::uint64_t DiscreteRandomNoise::noise(
 	std::uint32_t x, std::uint32_t y, std::uint32_t z
 ) const noexcept {
+	if (backend_ == NoiseBackend::MultiplyXorshift) {
+		return mix_noise(x, y, z);
+	}
+
 	auto A = map(x);
 	auto B = map(y ^ A);
 	auto C = map(z ^ B);
@@ -160,15 +187,15 @@ UniformPerlinNoise::UniformPerlinNoise(Xoroshiro128PP rng)
 	: noise_(rng), calibrate_rng_(rng), is_calibrated_(false) {}
 
 void UniformPerlinNoise::calibrate(
-	double scale, int octaves, double persistence, int sample_size
+	double scale, int octaves, double persistence, int sample_size,
+	std::uint32_t quantile_buckets
 ) {
 	scale_ = scale;
 	octaves_ = octaves;
 	persistence_ = persistence;
 
-	// Clear previous calibration
-	cdf_values_.clear();
-	cdf_values_.reserve(sample_size);
+	std::vector<double> cdf_values; // Sorted noise values for CDF
+	cdf_values.reserve(sample_size);
 
 	// Sample noise values across a reasonable range
 	Xoroshiro128PP rng = calibrate_rng_;
@@ -188,13 +215,42 @@ void UniformPerlinNoise::calibrate(
 			);
 		}
 
-		cdf_values_.push_back(noise_value);
+		cdf_values.push_back(noise_value);
 	}
 
 	// Sort values to create CDF
-	std::sort(cdf_values_.begin(), cdf_values_.end());
+	std::sort(cdf_values.begin(), cdf_values.end());
 
+	// Exact empirical quantile: fraction of samples below the value
+	auto exact_quantile = [&](double value) {
+		auto it = std::lower_bound(
+			cdf_values.begin(), cdf_values.end(), value
+		);
+		return static_cast<double>(it - cdf_values.begin())
+			/ cdf_values.size();
+	};
+
+	// Tabulate the quantiles at evenly spaced boundaries
+	quantile_buckets = std::max<std::uint32_t>(quantile_buckets, 1);
+	table_min_ = cdf_values.front();
+	table_max_ = cdf_values.back();
+	const double range = table_max_ - table_min_;
+	bucket_scale_ = range > 0.0 ? quantile_buckets / range : 0.0;
+
+	quantiles_.resize(quantile_buckets + 1);
+	for (std::uint32_t i = 0; i < quantile_buckets; ++i) {
+		const double boundary = table_min_ + range * i / quantile_buckets;
+		quantiles_[i] = exact_quantile(boundary);
+	}
+	quantiles_.back() = exact_quantile(table_max_);
+
+	// Measure how far the table strays from the exact quantiles
 	is_calibrated_ = true;
+	quantile_error_ = 0.0;
+	for (double value : cdf_values) {
+		const double error = map_to_uniform(value) - exact_quantile(value);
+		quantile_error_ = std::max(quantile_error_, std::abs(error));
+	}
 }
 
 double UniformPerlinNoise::uniform_noise(double x, double y) const {
@@ -219,14 +275,22 @@ double UniformPerlinNoise::uniform_noise(double x, double y) const {
 }
 
 double UniformPerlinNoise::map_to_uniform(double raw_value) const {
-	// Find position in CDF using binary search
-	auto it = std::lower_bound(
-		cdf_values_.begin(), cdf_values_.end(), raw_value
-	);
+	// Nothing was sampled below the smallest sample or above the largest
+	if (raw_value <= table_min_) {
+		return 0.0;
+	}
+	if (raw_value > table_max_) {
+		return 1.0;
+	}
 
-	// Calculate quantile (position in CDF as fraction)
-	size_t position = std::distance(cdf_values_.begin(), it);
-	double quantile = static_cast<double>(position) / cdf_values_.size();
+	// Locate the bucket and interpolate between its boundaries
+	const double position = (raw_value - table_min_) * bucket_scale_;
+	const std::size_t bucket = std::min<std::size_t>(
+		static_cast<std::size_t>(position), quantiles_.size() - 2
+	);
+	const double t = position - bucket;
+	const double quantile = quantiles_[bucket]
+		+ t * (quantiles_[bucket + 1] - quantiles_[bucket]);
 
 	// Clamp to [0,1] range
 	return std::max(0.0, std::min(1.0, quantile));
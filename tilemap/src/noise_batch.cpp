@@ -0,0 +1,477 @@
+#include "tilemap/noise.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define ISTD_TILEMAP_NOISE_SSE2
+#if defined(__GNUC__)
+#define ISTD_TILEMAP_NOISE_AVX2
+#endif
+#endif
+
+namespace istd {
+
+namespace {
+
+// Points evaluated per block; the per-block buffers stay in L1
+constexpr std::size_t block_size = 64;
+
+// Gradient of PerlinNoise::grad() as (gx, gy) so that grad(h, x, y) equals
+// gx[h] * x + gy[h] * y. The components are -1, 0 or 1, so the products are
+// exact and the sum matches grad() bit for bit.
+struct GradientTable {
+	std::array<double, 16> gx;
+	std::array<double, 16> gy;
+};
+
+constexpr GradientTable make_gradient_table() {
+	GradientTable table{};
+	for (int h = 0; h < 16; ++h) {
+		const double su = (h & 1) == 0 ? 1.0 : -1.0;
+		const double sv = (h & 2) == 0 ? 1.0 : -1.0;
+		// u = h < 8 ? x : y
+		(h < 8 ? table.gx : table.gy)[h] += su;
+		// v = h < 4 ? y : h == 12 || h == 14 ? x : 0
+		if (h < 4) {
+			table.gy[h] += sv;
+		} else if (h == 12 || h == 14) {
+			table.gx[h] += sv;
+		}
+	}
+	return table;
+}
+
+constexpr GradientTable gradient_table = make_gradient_table();
+
+// Per-point inputs of one octave: fractional Y and the corner gradients in
+// the order AA, BA, AB, BB of PerlinNoise::noise()
+struct CornerBlock {
+	alignas(32) double yf[block_size];
+	alignas(32) double gx[4][block_size];
+	alignas(32) double gy[4][block_size];
+};
+
+// Combine one point, mirroring PerlinNoise::noise() operation by operation
+inline void combine_one(
+	const CornerBlock &block, std::size_t i, double xf, double u,
+	double amplitude, double *value
+) {
+	const double x1 = xf - 1;
+	const double y = block.yf[i];
+	const double y1 = y - 1;
+	const double v = y * y * y * (y * (y * 6 - 15) + 10);
+
+	const double g_aa = block.gx[0][i] * xf + block.gy[0][i] * y;
+	const double g_ba = block.gx[1][i] * x1 + block.gy[1][i] * y;
+	const double g_ab = block.gx[2][i] * xf + block.gy[2][i] * y1;
+	const double g_bb = block.gx[3][i] * x1 + block.gy[3][i] * y1;
+
+	const double l1 = g_aa + u * (g_ba - g_aa);
+	const double l2 = g_ab + u * (g_bb - g_ab);
+	const double result = l1 + v * (l2 - l1);
+	value[i] += (result + 1.0) * 0.5 * amplitude;
+}
+
+#ifndef ISTD_TILEMAP_NOISE_SSE2
+void combine_scalar(
+	const CornerBlock &block, std::size_t count, double xf, double u,
+	double amplitude, double *value
+) {
+	for (std::size_t i = 0; i < count; ++i) {
+		combine_one(block, i, xf, u, amplitude, value);
+	}
+}
+#endif
+
+#ifdef ISTD_TILEMAP_NOISE_SSE2
+void combine_sse2(
+	const CornerBlock &block, std::size_t count, double xf, double u,
+	double amplitude, double *value
+) {
+	const __m128d one = _mm_set1_pd(1.0);
+	const __m128d half = _mm_set1_pd(0.5);
+	const __m128d six = _mm_set1_pd(6.0);
+	const __m128d fifteen = _mm_set1_pd(15.0);
+	const __m128d ten = _mm_set1_pd(10.0);
+	const __m128d vxf = _mm_set1_pd(xf);
+	const __m128d vx1 = _mm_set1_pd(xf - 1);
+	const __m128d vu = _mm_set1_pd(u);
+	const __m128d vamp = _mm_set1_pd(amplitude);
+
+	auto grad = [&](int corner, std::size_t i, __m128d x, __m128d y) {
+		return _mm_add_pd(
+			_mm_mul_pd(_mm_load_pd(&block.gx[corner][i]), x),
+			_mm_mul_pd(_mm_load_pd(&block.gy[corner][i]), y)
+		);
+	};
+	auto lerp = [](__m128d t, __m128d a, __m128d b) {
+		return _mm_add_pd(a, _mm_mul_pd(t, _mm_sub_pd(b, a)));
+	};
+
+	std::size_t i = 0;
+	for (; i + 2 <= count; i += 2) {
+		const __m128d y = _mm_load_pd(&block.yf[i]);
+		const __m128d y1 = _mm_sub_pd(y, one);
+		const __m128d inner = _mm_add_pd(
+			_mm_mul_pd(y, _mm_sub_pd(_mm_mul_pd(y, six), fifteen)), ten
+		);
+		const __m128d v = _mm_mul_pd(
+			_mm_mul_pd(_mm_mul_pd(y, y), y), inner
+		);
+
+		const __m128d l1 = lerp(vu, grad(0, i, vxf, y), grad(1, i, vx1, y));
+		const __m128d l2 = lerp(vu, grad(2, i, vxf, y1), grad(3, i, vx1, y1));
+		const __m128d result = lerp(v, l1, l2);
+		const __m128d noise = _mm_mul_pd(_mm_add_pd(result, one), half);
+		const __m128d sum = _mm_add_pd(
+			_mm_loadu_pd(value + i), _mm_mul_pd(noise, vamp)
+		);
+		_mm_storeu_pd(value + i, sum);
+	}
+	for (; i < count; ++i) {
+		combine_one(block, i, xf, u, amplitude, value);
+	}
+}
+#endif
+
+#ifdef ISTD_TILEMAP_NOISE_AVX2
+__attribute__((target("avx2"))) void combine_avx2(
+	const CornerBlock &block, std::size_t count, double xf, double u,
+	double amplitude, double *value
+) {
+	const __m256d one = _mm256_set1_pd(1.0);
+	const __m256d half = _mm256_set1_pd(0.5);
+	const __m256d six = _mm256_set1_pd(6.0);
+	const __m256d fifteen = _mm256_set1_pd(15.0);
+	const __m256d ten = _mm256_set1_pd(10.0);
+	const __m256d vxf = _mm256_set1_pd(xf);
+	const __m256d vx1 = _mm256_set1_pd(xf - 1);
+	const __m256d vu = _mm256_set1_pd(u);
+	const __m256d vamp = _mm256_set1_pd(amplitude);
+
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m256d y = _mm256_load_pd(&block.yf[i]);
+		const __m256d y1 = _mm256_sub_pd(y, one);
+		const __m256d inner = _mm256_add_pd(
+			_mm256_mul_pd(y, _mm256_sub_pd(_mm256_mul_pd(y, six), fifteen)),
+			ten
+		);
+		const __m256d v = _mm256_mul_pd(
+			_mm256_mul_pd(_mm256_mul_pd(y, y), y), inner
+		);
+
+		// Lambdas would not inherit the target attribute, so spell out the
+		// four corner gradients
+		const __m256d g_aa = _mm256_add_pd(
+			_mm256_mul_pd(_mm256_load_pd(&block.gx[0][i]), vxf),
+			_mm256_mul_pd(_mm256_load_pd(&block.gy[0][i]), y)
+		);
+		const __m256d g_ba = _mm256_add_pd(
+			_mm256_mul_pd(_mm256_load_pd(&block.gx[1][i]), vx1),
+			_mm256_mul_pd(_mm256_load_pd(&block.gy[1][i]), y)
+		);
+		const __m256d g_ab = _mm256_add_pd(
+			_mm256_mul_pd(_mm256_load_pd(&block.gx[2][i]), vxf),
+			_mm256_mul_pd(_mm256_load_pd(&block.gy[2][i]), y1)
+		);
+		const __m256d g_bb = _mm256_add_pd(
+			_mm256_mul_pd(_mm256_load_pd(&block.gx[3][i]), vx1),
+			_mm256_mul_pd(_mm256_load_pd(&block.gy[3][i]), y1)
+		);
+
+		const __m256d l1 = _mm256_add_pd(
+			g_aa, _mm256_mul_pd(vu, _mm256_sub_pd(g_ba, g_aa))
+		);
+		const __m256d l2 = _mm256_add_pd(
+			g_ab, _mm256_mul_pd(vu, _mm256_sub_pd(g_bb, g_ab))
+		);
+		const __m256d result = _mm256_add_pd(
+			l1, _mm256_mul_pd(v, _mm256_sub_pd(l2, l1))
+		);
+		const __m256d noise = _mm256_mul_pd(_mm256_add_pd(result, one), half);
+		const __m256d sum = _mm256_add_pd(
+			_mm256_loadu_pd(value + i), _mm256_mul_pd(noise, vamp)
+		);
+		_mm256_storeu_pd(value + i, sum);
+	}
+	for (; i < count; ++i) {
+		combine_one(block, i, xf, u, amplitude, value);
+	}
+}
+#endif
+
+bool cpu_has_avx2() {
+#ifdef ISTD_TILEMAP_NOISE_AVX2
+	// May run before the CPU model is initialized by its own constructor
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+const bool has_avx2 = cpu_has_avx2();
+
+using CombineFn = void (*)(
+	const CornerBlock &, std::size_t, double, double, double, double *
+);
+
+// Pick the widest kernel the CPU supports
+CombineFn select_combine() {
+#ifdef ISTD_TILEMAP_NOISE_AVX2
+	if (has_avx2) {
+		return combine_avx2;
+	}
+#endif
+#ifdef ISTD_TILEMAP_NOISE_SSE2
+	return combine_sse2;
+#else
+	return combine_scalar;
+#endif
+}
+
+const CombineFn combine = select_combine();
+
+#ifdef ISTD_TILEMAP_NOISE_AVX2
+// DiscreteRandomNoise coordinates hashed per AVX2 batch, one per byte lane
+constexpr std::size_t hash_lanes = 32;
+
+// 32-bit words of 32 coordinates split into byte planes: plane j holds byte j
+// of every word. DiscreteRandomNoise::map_once() works byte by byte and rot8
+// only renames bytes, so the whole hash can run on planes.
+struct BytePlanes {
+	__m256i plane[4];
+};
+
+// Look up 32 bytes in a 256-entry table given as 16 rows of 16 bytes, each
+// broadcast to both 128-bit lanes. For row r, index - 16r lands in [0, 16)
+// only for indices of that row; the saturating add of 0x70 keeps those below
+// 0x80 and pushes every other index to 0x80 or above, where the shuffle
+// yields zero.
+__attribute__((target("avx2"))) inline __m256i lookup_avx2(
+	const __m256i *table, __m256i index
+) {
+	const __m256i bias = _mm256_set1_epi8(0x70);
+	const __m256i row_step = _mm256_set1_epi8(16);
+
+	__m256i result = _mm256_shuffle_epi8(
+		table[0], _mm256_adds_epu8(index, bias)
+	);
+	// Fully unrolled, otherwise GCC keeps the accumulator on the stack
+#pragma GCC unroll 16
+	for (int row = 1; row < 16; ++row) {
+		index = _mm256_sub_epi8(index, row_step);
+		const __m256i value = _mm256_shuffle_epi8(
+			table[row], _mm256_adds_epu8(index, bias)
+		);
+		result = _mm256_or_si256(result, value);
+	}
+	return result;
+}
+
+// DiscreteRandomNoise::map() on byte planes
+__attribute__((target("avx2"))) inline BytePlanes map_avx2(
+	const __m256i *table, BytePlanes x
+) {
+	for (int i = 0; i < 3; ++i) {
+		const __m256i a = lookup_avx2(table, x.plane[0]);
+		const __m256i b = lookup_avx2(table, _mm256_xor_si256(x.plane[1], a));
+		const __m256i c = lookup_avx2(table, _mm256_xor_si256(x.plane[2], b));
+		const __m256i d = lookup_avx2(table, _mm256_xor_si256(x.plane[3], c));
+		// rot8 moves byte 3 to byte 0 and the others up by one
+		x.plane[0] = d;
+		x.plane[1] = a;
+		x.plane[2] = b;
+		x.plane[3] = c;
+	}
+	return x;
+}
+
+__attribute__((target("avx2"))) inline BytePlanes xor_avx2(
+	BytePlanes a, BytePlanes b
+) {
+	for (int j = 0; j < 4; ++j) {
+		a.plane[j] = _mm256_xor_si256(a.plane[j], b.plane[j]);
+	}
+	return a;
+}
+
+// Hash count coordinates (a multiple of hash_lanes), mirroring
+// DiscreteRandomNoise::noise()
+__attribute__((target("avx2"))) void hash_avx2(
+	const std::uint8_t *permutation, std::uint64_t mask,
+	const NoiseCoord *coords, std::size_t count, std::uint64_t *out
+) {
+	__m256i table[16];
+	for (int row = 0; row < 16; ++row) {
+		table[row] = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+			reinterpret_cast<const __m128i *>(permutation + row * 16)
+		));
+	}
+
+	alignas(32) std::uint8_t bytes[3][4][hash_lanes];
+	for (std::size_t begin = 0; begin < count; begin += hash_lanes) {
+		// Transpose the coordinates into byte planes
+		for (std::size_t i = 0; i < hash_lanes; ++i) {
+			const NoiseCoord &coord = coords[begin + i];
+			for (int j = 0; j < 4; ++j) {
+				bytes[0][j][i] = coord.x >> (8 * j);
+				bytes[1][j][i] = coord.y >> (8 * j);
+				bytes[2][j][i] = coord.z >> (8 * j);
+			}
+		}
+		BytePlanes planes[3];
+		for (int k = 0; k < 3; ++k) {
+			for (int j = 0; j < 4; ++j) {
+				planes[k].plane[j] = _mm256_load_si256(
+					reinterpret_cast<const __m256i *>(bytes[k][j])
+				);
+			}
+		}
+		const BytePlanes &x = planes[0];
+		const BytePlanes &y = planes[1];
+		const BytePlanes &z = planes[2];
+
+		const BytePlanes A = map_avx2(table, x);
+		const BytePlanes B = map_avx2(table, xor_avx2(y, A));
+		const BytePlanes C = map_avx2(table, xor_avx2(z, B));
+		const BytePlanes D = map_avx2(table, z);
+		const BytePlanes E = map_avx2(table, xor_avx2(y, D));
+		const BytePlanes F = map_avx2(table, xor_avx2(x, E));
+
+		// Transpose back: C forms the high and F the low 32 bits
+		for (int j = 0; j < 4; ++j) {
+			_mm256_store_si256(
+				reinterpret_cast<__m256i *>(bytes[0][j]), C.plane[j]
+			);
+			_mm256_store_si256(
+				reinterpret_cast<__m256i *>(bytes[1][j]), F.plane[j]
+			);
+		}
+		for (std::size_t i = 0; i < hash_lanes; ++i) {
+			std::uint64_t value = 0;
+			for (int j = 0; j < 4; ++j) {
+				value |= static_cast<std::uint64_t>(bytes[0][j][i])
+					<< (32 + 8 * j);
+				value |= static_cast<std::uint64_t>(bytes[1][j][i]) << (8 * j);
+			}
+			out[begin + i] = value ^ mask;
+		}
+	}
+}
+#endif
+
+} // namespace
+
+void DiscreteRandomNoise::noise_batch(
+	std::span<const NoiseCoord> coords, std::span<std::uint64_t> out
+) const {
+	if (out.size() != coords.size()) {
+		throw std::invalid_argument("noise_batch: size mismatch");
+	}
+
+	std::size_t done = 0;
+#ifdef ISTD_TILEMAP_NOISE_AVX2
+	if (has_avx2 && backend_ == NoiseBackend::Permutation) {
+		done = coords.size() - coords.size() % hash_lanes;
+		hash_avx2(
+			permutation_.data(), mask, coords.data(), done, out.data()
+		);
+	}
+#endif
+	if (backend_ == NoiseBackend::MultiplyXorshift) {
+		for (std::size_t i = done; i < coords.size(); ++i) {
+			out[i] = mix_noise(coords[i].x, coords[i].y, coords[i].z);
+		}
+		return;
+	}
+	for (std::size_t i = done; i < coords.size(); ++i) {
+		out[i] = noise(coords[i].x, coords[i].y, coords[i].z);
+	}
+}
+
+void PerlinNoise::octave_noise_row(
+	double x, std::span<const double> ys, int octaves, double persistence,
+	std::span<double> out
+) const {
+	if (out.size() != ys.size()) {
+		throw std::invalid_argument("octave_noise_row: size mismatch");
+	}
+
+	const int *p = permutation_.data();
+	CornerBlock block;
+	std::array<double, block_size> value;
+
+	for (std::size_t begin = 0; begin < ys.size(); begin += block_size) {
+		const std::size_t count = std::min(block_size, ys.size() - begin);
+		std::fill_n(value.begin(), count, 0.0);
+
+		double amplitude = 1.0;
+		double frequency = 1.0;
+		double max_value = 0.0;
+		for (int octave = 0; octave < octaves; ++octave) {
+			// The X lattice cell is shared by the whole row
+			const double fx = x * frequency;
+			const double x_floor = std::floor(fx);
+			const int X = static_cast<int>(x_floor) & 255;
+			const double xf = fx - x_floor;
+			const double u = xf * xf * xf * (xf * (xf * 6 - 15) + 10);
+
+			// Gather the corner hashes point by point
+			for (std::size_t i = 0; i < count; ++i) {
+				const double fy = ys[begin + i] * frequency;
+				const double y_floor = std::floor(fy);
+				const int Y = static_cast<int>(y_floor) & 255;
+				block.yf[i] = fy - y_floor;
+
+				const int A = p[X] + Y;
+				const int B = p[X + 1] + Y;
+				const int hashes[4] = {
+					p[p[A]], p[p[B]], p[p[A + 1]], p[p[B + 1]]
+				};
+				for (int corner = 0; corner < 4; ++corner) {
+					const int h = hashes[corner] & 15;
+					block.gx[corner][i] = gradient_table.gx[h];
+					block.gy[corner][i] = gradient_table.gy[h];
+				}
+			}
+
+			combine(block, count, xf, u, amplitude, value.data());
+			max_value += amplitude;
+			amplitude *= persistence;
+			frequency *= 2.0;
+		}
+
+		for (std::size_t i = 0; i < count; ++i) {
+			out[begin + i] = value[i] / max_value;
+		}
+	}
+}
+
+void UniformPerlinNoise::uniform_noise_row(
+	double x, std::span<const double> ys, std::span<double> out
+) const {
+	if (!is_calibrated_) {
+		throw std::runtime_error(
+			"UniformPerlinNoise must be calibrated before use"
+		);
+	}
+	if (out.size() != ys.size()) {
+		throw std::invalid_argument("uniform_noise_row: size mismatch");
+	}
+
+	// Scale in place; octave_noise_row() reads each Y before writing it
+	for (std::size_t i = 0; i < ys.size(); ++i) {
+		out[i] = ys[i] * scale_;
+	}
+	noise_.octave_noise_row(x * scale_, out, octaves_, persistence_, out);
+	for (double &value : out) {
+		value = map_to_uniform(value);
+	}
+}
+
+} // namespace istd
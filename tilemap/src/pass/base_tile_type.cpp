@@ -2,6 +2,7 @@
 #include "tilemap/biome.h"
 #include "tilemap/chunk.h"
 #include "tilemap/generation.h"
+#include <array>
 #include <utility>
 
 namespace istd {
@@ -11,71 +12,57 @@ BaseTileTypeGenerationPass::BaseTileTypeGenerationPass(
 )
 	: config_(config), base_noise_(rng) {
 	base_noise_.calibrate(
-		config.base_scale, config.base_octaves, config.base_persistence
+		config.base_scale, config.base_octaves, config.base_persistence, 10000,
+		config.noise_quantile_buckets
 	);
 }
 
 void BaseTileTypeGenerationPass::operator()(TileMap &tilemap) {
-	// Generate base tile types for each chunk
-	std::uint8_t map_size = tilemap.get_size();
-	for (std::uint8_t chunk_x = 0; chunk_x < map_size; ++chunk_x) {
-		for (std::uint8_t chunk_y = 0; chunk_y < map_size; ++chunk_y) {
-			generate_chunk(tilemap, chunk_x, chunk_y);
-		}
-	}
+	WorkerPool pool(1);
+	(*this)(tilemap, pool);
 }
 
-void BaseTileTypeGenerationPass::generate_chunk(
-	TileMap &tilemap, std::uint8_t chunk_x, std::uint8_t chunk_y
+void BaseTileTypeGenerationPass::operator()(
+	TileMap &tilemap, WorkerPool &pool
 ) {
-	const Chunk &chunk = tilemap.get_chunk(chunk_x, chunk_y);
-
-	// Generate each sub-chunk with its corresponding biome
-	for (std::uint8_t sub_x = 0; sub_x < Chunk::subchunk_count; ++sub_x) {
-		for (std::uint8_t sub_y = 0; sub_y < Chunk::subchunk_count; ++sub_y) {
-			SubChunkPos sub_pos(sub_x, sub_y);
-			BiomeType biome = chunk.get_biome(sub_pos);
-			generate_subchunk(tilemap, chunk_x, chunk_y, sub_pos, biome);
-		}
-	}
+	// Each chunk only reads its own biomes and the (immutable) noise, so
+	// chunks can be generated in any order
+	const std::uint32_t map_size = tilemap.get_size();
+	pool.parallel_for(map_size * map_size, [&](std::uint32_t i) {
+		generate_chunk(tilemap, i / map_size, i % map_size);
+	});
 }
 
-void BaseTileTypeGenerationPass::generate_subchunk(
-	TileMap &tilemap, std::uint8_t chunk_x, std::uint8_t chunk_y,
-	SubChunkPos sub_pos, BiomeType biome
-) {
-	const BiomeProperties &properties = get_biome_properties(biome);
-
-	// Get starting tile coordinates for this sub-chunk
-	auto [start_x, start_y] = subchunk_to_tile_start(sub_pos);
+void BaseTileTypeGenerationPass::generate_chunk(
+	TileMap &tilemap, ChunkCoord chunk_x, ChunkCoord chunk_y
+) const {
+	Chunk &chunk = tilemap.get_chunk_unchecked(chunk_x, chunk_y);
+	const auto [chunk_global_x, chunk_global_y] = tilemap.world_coords(
+		{chunk_x, chunk_y, 0, 0}
+	);
 
-	// Generate terrain for each tile in the sub-chunk
-	for (std::uint8_t local_x = start_x;
-	     local_x < start_x + Chunk::subchunk_size; ++local_x) {
-		for (std::uint8_t local_y = start_y;
-		     local_y < start_y + Chunk::subchunk_size; ++local_y) {
-			// Calculate global coordinates
-			double global_x = chunk_x * Chunk::size + local_x;
-			double global_y = chunk_y * Chunk::size + local_y;
+	// Global Y coordinates of a chunk row
+	std::array<double, Chunk::size> global_ys;
+	for (std::uint8_t local_y = 0; local_y < Chunk::size; ++local_y) {
+		global_ys[local_y] = chunk_global_y + local_y;
+	}
 
-			// Generate base terrain noise value using uniform distribution
-			double base_noise_value = base_noise_.uniform_noise(
-				global_x, global_y
-			);
+	// Generate one row of tiles at a time, evaluating its noise in a batch
+	std::array<double, Chunk::size> noise_values;
+	for (std::uint8_t local_x = 0; local_x < Chunk::size; ++local_x) {
+		double global_x = chunk_global_x + local_x;
+		base_noise_.uniform_noise_row(global_x, global_ys, noise_values);
 
-			// Determine base terrain type
-			BaseTileType base_type = determine_base_type(
-				base_noise_value, properties
-			);
+		for (std::uint8_t local_y = 0; local_y < Chunk::size; ++local_y) {
+			// Look up the biome of the sub-chunk containing this tile
+			BiomeType biome = chunk.get_biome(local_x, local_y);
+			const BiomeProperties &properties = get_biome_properties(biome);
 
 			// Create tile with base and surface components
 			Tile tile;
-			tile.base = base_type;
+			tile.base = determine_base_type(noise_values[local_y], properties);
 			tile.surface = SurfaceTileType::Empty;
-
-			// Set the tile
-			TilePos pos{chunk_x, chunk_y, local_x, local_y};
-			tilemap.set_tile(pos, tile);
+			chunk.tiles[local_x][local_y] = tile;
 		}
 	}
 }
@@ -101,10 +88,4 @@ BaseTileType BaseTileTypeGenerationPass::determine_base_type(
 	std::unreachable();
 }
 
-void TerrainGenerator::base_tile_type_pass(TileMap &tilemap) {
-	BaseTileTypeGenerationPass pass(config_, master_rng_);
-	master_rng_ = master_rng_.jump_96();
-	pass(tilemap);
-}
-
 } // namespace istd
\ No newline at end of file
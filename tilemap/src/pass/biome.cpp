@@ -1,6 +1,7 @@
 #include "tilemap/biome.h"
 #include "tilemap/generation.h"
 #include "tilemap/pass/biome.h"
+#include <array>
 
 namespace istd {
 
@@ -10,76 +11,81 @@ BiomeGenerationPass::BiomeGenerationPass(
 	: config_(config), temperature_noise_(r1), humidity_noise_(r2) {
 	temperature_noise_.calibrate(
 		config.temperature_scale, config.temperature_octaves,
-		config.temperature_persistence
+		config.temperature_persistence, 10000, config.noise_quantile_buckets
 	);
 	humidity_noise_.calibrate(
 		config.humidity_scale, config.humidity_octaves,
-		config.humidity_persistence
+		config.humidity_persistence, 10000, config.noise_quantile_buckets
 	);
 }
 
 void BiomeGenerationPass::operator()(TileMap &tilemap) {
-	std::uint8_t map_size = tilemap.get_size();
+	WorkerPool pool(1);
+	(*this)(tilemap, pool);
+}
+
+void BiomeGenerationPass::operator()(TileMap &tilemap, WorkerPool &pool) {
+	// Chunks only read the (immutable) noise, so they can run in any order
+	const std::uint32_t map_size = tilemap.get_size();
+	pool.parallel_for(map_size * map_size, [&](std::uint32_t i) {
+		generate_chunk(tilemap, i / map_size, i % map_size);
+	});
+}
 
-	// Generate biomes for each sub-chunk
-	for (std::uint8_t chunk_x = 0; chunk_x < map_size; ++chunk_x) {
-		for (std::uint8_t chunk_y = 0; chunk_y < map_size; ++chunk_y) {
-			auto &chunk = tilemap.get_chunk(chunk_x, chunk_y);
+void BiomeGenerationPass::generate_chunk(
+	TileMap &tilemap, ChunkCoord chunk_x, ChunkCoord chunk_y
+) const {
+	auto &chunk = tilemap.get_chunk_unchecked(chunk_x, chunk_y);
+	const auto [chunk_global_x, chunk_global_y] = tilemap.world_coords(
+		{chunk_x, chunk_y, 0, 0}
+	);
 
-			for (std::uint8_t sub_x = 0; sub_x < Chunk::subchunk_count;
-			     ++sub_x) {
-				for (std::uint8_t sub_y = 0; sub_y < Chunk::subchunk_count;
-				     ++sub_y) {
-					// Calculate global position for this sub-chunk's center
-					auto [start_x, start_y] = subchunk_to_tile_start(
-						{sub_x, sub_y}
-					);
+	// Global Y coordinates of the sub-chunk centers in a row
+	std::array<double, Chunk::subchunk_count> global_ys;
+	for (std::uint8_t sub_y = 0; sub_y < Chunk::subchunk_count; ++sub_y) {
+		global_ys[sub_y] = chunk_global_y
+			+ sub_y * Chunk::subchunk_size + (Chunk::subchunk_size >> 1);
+	}
 
-					double global_x = chunk_x * Chunk::size + start_x
-						+ (Chunk::subchunk_size >> 1);
-					double global_y = chunk_y * Chunk::size + start_y
-						+ (Chunk::subchunk_size >> 1);
+	// Generate biomes for each row of sub-chunks
+	std::array<double, Chunk::subchunk_count> temperature;
+	std::array<double, Chunk::subchunk_count> humidity;
+	for (std::uint8_t sub_x = 0; sub_x < Chunk::subchunk_count; ++sub_x) {
+		// Calculate global position for this sub-chunk row's centers
+		double global_x = chunk_global_x
+			+ sub_x * Chunk::subchunk_size + (Chunk::subchunk_size >> 1);
 
-					// Get climate values
-					auto [temperature, humidity] = get_climate(
-						global_x, global_y
-					);
+		// Get climate values
+		get_climate_row(global_x, global_ys, temperature, humidity);
 
-					// Determine biome and store directly in chunk
-					BiomeType biome = determine_biome(temperature, humidity);
-					chunk.biome[sub_x][sub_y] = biome;
-				}
-			}
+		// Determine biome and store directly in chunk
+		for (std::uint8_t sub_y = 0; sub_y < Chunk::subchunk_count; ++sub_y) {
+			chunk.biome[sub_x][sub_y] = determine_biome(
+				temperature[sub_y], humidity[sub_y]
+			);
 		}
 	}
 }
 
-std::pair<double, double> BiomeGenerationPass::get_climate(
-	double global_x, double global_y
+void BiomeGenerationPass::get_climate_row(
+	double global_x, std::span<const double> global_ys,
+	std::span<double> temperature, std::span<double> humidity
 ) const {
 	// Generate temperature noise (0-1 range)
-	double temperature = temperature_noise_.uniform_noise(
-		global_x * config_.temperature_scale,
-		global_y * config_.temperature_scale
+	for (std::size_t i = 0; i < global_ys.size(); ++i) {
+		temperature[i] = global_ys[i] * config_.temperature_scale;
+	}
+	temperature_noise_.uniform_noise_row(
+		global_x * config_.temperature_scale, temperature, temperature
 	);
 
 	// Generate humidity noise (0-1 range)
-	double humidity = humidity_noise_.uniform_noise(
-		global_x * config_.humidity_scale, global_y * config_.humidity_scale
+	for (std::size_t i = 0; i < global_ys.size(); ++i) {
+		humidity[i] = global_ys[i] * config_.humidity_scale;
+	}
+	humidity_noise_.uniform_noise_row(
+		global_x * config_.humidity_scale, humidity, humidity
 	);
-
-	return {temperature, humidity};
-}
-
-void TerrainGenerator::biome_pass(TileMap &tilemap) {
-	// Create two RNGs for temperature and humidity noise
-	Xoroshiro128PP temp_rng = master_rng_;
-	master_rng_ = master_rng_.jump_96();
-	Xoroshiro128PP humidity_rng = master_rng_;
-	master_rng_ = master_rng_.jump_96();
-
-	BiomeGenerationPass biome_pass(config_, temp_rng, humidity_rng);
-	biome_pass(tilemap);
 }
 
 } // namespace istd
@@ -13,15 +13,15 @@ namespace istd {
 CoalGenerationPass::CoalGenerationPass(
 	const GenerationConfig &config, Xoroshiro128PP rng, Xoroshiro128PP noise_rng
 )
-	: config_(config), rng_(rng), noise_(noise_rng) {}
+	: config_(config), rng_(rng), noise_(noise_rng, config.noise_backend) {}
 
 void CoalGenerationPass::operator()(TileMap &tilemap) {
-	std::uint8_t map_size = tilemap.get_size();
+	ChunkCoord map_size = tilemap.get_size();
 	std::vector<TilePos> all_seeds;
 
 	// Generate coal seeds for each chunk
-	for (std::uint8_t chunk_x = 0; chunk_x < map_size; ++chunk_x) {
-		for (std::uint8_t chunk_y = 0; chunk_y < map_size; ++chunk_y) {
+	for (ChunkCoord chunk_x = 0; chunk_x < map_size; ++chunk_x) {
+		for (ChunkCoord chunk_y = 0; chunk_y < map_size; ++chunk_y) {
 			chunk_coal_seeds(tilemap, chunk_x, chunk_y, all_seeds);
 		}
 	}
@@ -31,27 +31,34 @@ void CoalGenerationPass::operator()(TileMap &tilemap) {
 }
 
 void CoalGenerationPass::chunk_coal_seeds(
-	const TileMap &tilemap, std::uint8_t chunk_x, std::uint8_t chunk_y,
+	const TileMap &tilemap, ChunkCoord chunk_x, ChunkCoord chunk_y,
 	std::vector<TilePos> &seeds
 ) {
-	// Use a max heap to keep top N positions by noise value
-	using PosNoisePair = std::pair<std::uint64_t, TilePos>;
-	std::priority_queue<PosNoisePair> heap;
-
+	// Collect suitable tiles and hash their noise in one batch
+	std::vector<TilePos> candidates;
+	std::vector<NoiseCoord> coords;
 	for (std::uint8_t local_x = 0; local_x < Chunk::size; ++local_x) {
 		for (std::uint8_t local_y = 0; local_y < Chunk::size; ++local_y) {
 			TilePos candidate{chunk_x, chunk_y, local_x, local_y};
-			if (!is_suitable_for_coal(tilemap, candidate)) {
+			if (!is_suitable_for_coal(tilemap.get_tile_unchecked(candidate))) {
 				continue;
 			}
 
-			auto [global_x, global_y] = candidate.to_global();
-			auto noise_val = noise_.noise(global_x, global_y, 0x90);
+			auto [global_x, global_y] = tilemap.world_coords(candidate);
+			candidates.push_back(candidate);
+			coords.push_back({global_x, global_y, 0x90});
+		}
+	}
+	std::vector<std::uint64_t> noise_values(coords.size());
+	noise_.noise_batch(coords, noise_values);
 
-			heap.emplace(noise_val, candidate);
-			if (heap.size() > config_.coal_seeds_per_chunk) {
-				heap.pop();
-			}
+	// Use a max heap to keep top N positions by noise value
+	using PosNoisePair = std::pair<std::uint64_t, TilePos>;
+	std::priority_queue<PosNoisePair> heap;
+	for (std::size_t i = 0; i < candidates.size(); ++i) {
+		heap.emplace(noise_values[i], candidates[i]);
+		if (heap.size() > config_.coal_seeds_per_chunk) {
+			heap.pop();
 		}
 	}
 
@@ -63,90 +70,103 @@ void CoalGenerationPass::chunk_coal_seeds(
 
 void CoalGenerationPass::evolve_coal_deposits(
 	TileMap &tilemap, const std::vector<TilePos> &initial_seeds
-) {
+) const {
+	const std::uint32_t width = tilemap.get_size() * Chunk::size;
+	auto index_of = [width](TilePos pos) {
+		auto [global_x, global_y] = pos.to_global();
+		return std::size_t(global_x) * width + global_y;
+	};
+
 	// Place initial seeds
 	for (const auto &seed : initial_seeds) {
-		Tile &tile = tilemap.get_tile(seed);
+		Tile &tile = tilemap.get_tile_unchecked(seed);
 		if (tile.surface == SurfaceTileType::Empty) {
 			tile.surface = SurfaceTileType::Coal;
 		}
 	}
 
-	// Evolve using cellular automata
-	for (std::uint8_t step = 1; step <= config_.coal_evolution_steps; ++step) {
-		std::vector<TilePos> new_coal_positions;
-		std::uint8_t map_size = tilemap.get_size();
-
-		// Iterate through all tiles
-		for (std::uint8_t chunk_x = 0; chunk_x < map_size; ++chunk_x) {
-			for (std::uint8_t chunk_y = 0; chunk_y < map_size; ++chunk_y) {
-				const Chunk &chunk = tilemap.get_chunk(chunk_x, chunk_y);
-
-				for (std::uint8_t local_x = 0; local_x < Chunk::size;
-				     ++local_x) {
-					for (std::uint8_t local_y = 0; local_y < Chunk::size;
-					     ++local_y) {
-						TilePos pos{chunk_x, chunk_y, local_x, local_y};
-						const Tile &tile = tilemap.get_tile(pos);
-
-						// Skip if not suitable for coal
-						if (!is_suitable_for_coal(tilemap, pos)) {
-							continue;
-						}
-
-						// Skip if already has coal
-						if (tile.surface == SurfaceTileType::Coal) {
-							continue;
-						}
-
-						// Count coal neighbors
-						std::uint8_t coal_neighbors = count_coal_neighbors(
-							tilemap, pos
-						);
-
-						if (coal_neighbors > 0) {
-							// Get biome for this position
-							BiomeType biome = chunk.get_biome(local_x, local_y);
-							auto biome_probability
-								= get_biome_coal_growth_probability(biome);
-
-							// Base probability increases with more coal
-							// neighbors
-							std::uint32_t base_probability = coal_neighbors
-								* config_.coal_growth_base_prob;
-							std::uint8_t final_probability = std::clamp(
-								base_probability * biome_probability / 255, 0u,
-								255u
-							);
-
-							// Use noise to decide whether to grow coal here
-							auto [global_x, global_y] = pos.to_global();
-							std::uint8_t sample = 0xFF
-								& noise_.noise(global_x, global_y, step);
-
-							if (sample < final_probability) {
-								new_coal_positions.push_back(pos);
-							}
-						}
-					}
-				}
+	// Cached number of coal neighbors per tile, and the frontier of suitable
+	// tiles with at least one coal neighbor. A tile joins the frontier when
+	// its count leaves zero and leaves it when it turns into coal.
+	std::vector<std::uint8_t> coal_neighbors(std::size_t(width) * width, 0);
+	std::vector<TilePos> frontier;
+	auto add_coal = [&](TilePos pos) {
+		for (const auto neighbor : tilemap.neighbors_of(pos)) {
+			if (coal_neighbors[index_of(neighbor)]++ == 0
+			    && is_suitable_for_coal(tilemap.get_tile_unchecked(neighbor))) {
+				frontier.push_back(neighbor);
+			}
+		}
+	};
+
+	for (GlobalCoord global_x = 0; global_x < width; ++global_x) {
+		for (GlobalCoord global_y = 0; global_y < width; ++global_y) {
+			const Tile &tile = tilemap.get_tile_unchecked(global_x, global_y);
+			if (tile.surface == SurfaceTileType::Coal) {
+				add_coal(TilePos::from_global(global_x, global_y));
 			}
 		}
+	}
 
-		// Place new coal
-		for (const auto &pos : new_coal_positions) {
-			Tile &tile = tilemap.get_tile(pos);
-			if (tile.surface == SurfaceTileType::Empty) {
-				tile.surface = SurfaceTileType::Coal;
+	// Evolve using cellular automata. All tiles of a step decide against the
+	// counts of the previous step before any new coal is placed.
+	std::vector<TilePos> grown;
+	std::vector<NoiseCoord> coords;
+	std::vector<std::uint64_t> samples;
+	for (std::uint8_t step = 1; step <= config_.coal_evolution_steps; ++step) {
+		// Hash the samples of the whole frontier in one batch
+		coords.clear();
+		for (const auto pos : frontier) {
+			auto [global_x, global_y] = tilemap.world_coords(pos);
+			coords.push_back({global_x, global_y, step});
+		}
+		samples.resize(coords.size());
+		noise_.noise_batch(coords, samples);
+
+		grown.clear();
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < frontier.size(); ++i) {
+			const TilePos pos = frontier[i];
+			const auto count = coal_neighbors[index_of(pos)];
+			if (should_grow_coal(tilemap, pos, count, samples[i])) {
+				grown.push_back(pos);
+			} else {
+				frontier[kept++] = pos;
 			}
 		}
+		frontier.resize(kept);
+
+		for (const auto pos : grown) {
+			tilemap.get_tile_unchecked(pos).surface = SurfaceTileType::Coal;
+		}
+		for (const auto pos : grown) {
+			add_coal(pos);
+		}
 	}
 }
 
-bool CoalGenerationPass::is_suitable_for_coal(
-	const TileMap &tilemap, TilePos pos
+bool CoalGenerationPass::should_grow_coal(
+	const TileMap &tilemap, TilePos pos, std::uint8_t coal_neighbors,
+	std::uint64_t noise_value
 ) const {
-	const Tile &tile = tilemap.get_tile(pos);
+	// Get biome for this position
+	const Chunk &chunk = tilemap.get_chunk_unchecked(pos.chunk_x, pos.chunk_y);
+	BiomeType biome = chunk.get_biome(pos);
+	auto biome_probability = get_biome_coal_growth_probability(biome);
+
+	// Base probability increases with more coal neighbors
+	std::uint32_t base_probability = coal_neighbors
+		* config_.coal_growth_base_prob;
+	std::uint8_t final_probability = std::clamp(
+		base_probability * biome_probability / 255, 0u, 255u
+	);
+
+	// Use noise to decide whether to grow coal here
+	std::uint8_t sample = 0xFF & noise_value;
+	return sample < final_probability;
+}
+
+bool CoalGenerationPass::is_suitable_for_coal(Tile tile) const {
 	return (tile.base == BaseTileType::Sand || tile.base == BaseTileType::Land)
 		&& tile.surface == SurfaceTileType::Empty;
 }
@@ -179,29 +199,4 @@ std::uint8_t CoalGenerationPass::get_biome_coal_growth_probability(
 	}
 }
 
-std::uint8_t CoalGenerationPass::count_coal_neighbors(
-	const TileMap &tilemap, TilePos pos
-) const {
-	std::uint8_t count = 0;
-	auto neighbors = tilemap.get_neighbors(pos);
-
-	for (const auto neighbor_pos : neighbors) {
-		const Tile &neighbor_tile = tilemap.get_tile(neighbor_pos);
-		if (neighbor_tile.surface == SurfaceTileType::Coal) {
-			++count;
-		}
-	}
-
-	return count;
-}
-
-void TerrainGenerator::coal_pass(TileMap &tilemap) {
-	auto rng = master_rng_;
-	master_rng_ = master_rng_.jump_96();
-	auto noise_rng = master_rng_;
-	master_rng_ = master_rng_.jump_96();
-	CoalGenerationPass pass(config_, rng, noise_rng);
-	pass(tilemap);
-}
-
 } // namespace istd
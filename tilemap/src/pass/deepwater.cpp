@@ -1,6 +1,7 @@
 #include "tilemap/pass/deepwater.h"
 #include "tilemap/biome.h"
 #include "tilemap/generation.h"
+#include <algorithm>
 
 namespace istd {
 
@@ -8,12 +9,20 @@ DeepwaterGenerationPass::DeepwaterGenerationPass(std::uint32_t deepwater_radius)
 	: deepwater_radius_(deepwater_radius) {}
 
 void DeepwaterGenerationPass::operator()(TileMap &tilemap) {
-	std::uint8_t map_size = tilemap.get_size();
+	ChunkCoord map_size = tilemap.get_size();
+
+	// A water tile becomes deepwater when no land lies within the radius, so
+	// distances beyond radius + 1 are irrelevant. Radii beyond the map width
+	// all cover the whole map.
+	const std::uint32_t radius = std::min<std::uint32_t>(
+		deepwater_radius_, map_size * Chunk::size
+	);
+	const auto distance = distance_to_land(tilemap, radius + 1);
 
 	// Iterate through all sub-chunks to check biomes efficiently
-	for (std::uint8_t chunk_x = 0; chunk_x < map_size; ++chunk_x) {
-		for (std::uint8_t chunk_y = 0; chunk_y < map_size; ++chunk_y) {
-			const Chunk &chunk = tilemap.get_chunk(chunk_x, chunk_y);
+	for (ChunkCoord chunk_x = 0; chunk_x < map_size; ++chunk_x) {
+		for (ChunkCoord chunk_y = 0; chunk_y < map_size; ++chunk_y) {
+			const Chunk &chunk = tilemap.get_chunk_unchecked(chunk_x, chunk_y);
 
 			// Process each sub-chunk
 			for (std::uint8_t sub_x = 0; sub_x < Chunk::subchunk_count;
@@ -32,17 +41,83 @@ void DeepwaterGenerationPass::operator()(TileMap &tilemap) {
 					}
 
 					// Process all tiles in this ocean sub-chunk
-					process_ocean_subchunk(tilemap, chunk_x, chunk_y, sub_pos);
+					process_ocean_subchunk(
+						tilemap, distance, radius, chunk_x, chunk_y, sub_pos
+					);
 				}
 			}
 		}
 	}
 }
 
+std::vector<std::uint16_t> DeepwaterGenerationPass::distance_to_land(
+	const TileMap &tilemap, std::uint16_t cap
+) {
+	const std::uint32_t width = tilemap.get_size() * Chunk::size;
+	std::vector<std::uint16_t> distance(std::size_t(width) * width);
+
+	// Forward sweep: seed land tiles and propagate from the upper-left half of
+	// the 8-neighborhood
+	for (std::uint32_t x = 0; x < width; ++x) {
+		std::uint16_t *row = distance.data() + std::size_t(x) * width;
+		const std::uint16_t *prev = x > 0 ? row - width : nullptr;
+		for (std::uint32_t y = 0; y < width; ++y) {
+			const Tile &tile = tilemap.get_tile_unchecked(x, y);
+			if (tile.base != BaseTileType::Water
+			    && tile.base != BaseTileType::Deepwater) {
+				row[y] = 0;
+				continue;
+			}
+
+			std::uint16_t best = cap;
+			if (y > 0) {
+				best = std::min<std::uint16_t>(best, row[y - 1] + 1);
+			}
+			if (prev != nullptr) {
+				best = std::min<std::uint16_t>(best, prev[y] + 1);
+				if (y > 0) {
+					best = std::min<std::uint16_t>(best, prev[y - 1] + 1);
+				}
+				if (y + 1 < width) {
+					best = std::min<std::uint16_t>(best, prev[y + 1] + 1);
+				}
+			}
+			row[y] = best;
+		}
+	}
+
+	// Backward sweep: propagate from the lower-right half
+	for (std::uint32_t x = width; x-- > 0;) {
+		std::uint16_t *row = distance.data() + std::size_t(x) * width;
+		const std::uint16_t *next = x + 1 < width ? row + width : nullptr;
+		for (std::uint32_t y = width; y-- > 0;) {
+			std::uint16_t best = row[y];
+			if (y + 1 < width) {
+				best = std::min<std::uint16_t>(best, row[y + 1] + 1);
+			}
+			if (next != nullptr) {
+				best = std::min<std::uint16_t>(best, next[y] + 1);
+				if (y > 0) {
+					best = std::min<std::uint16_t>(best, next[y - 1] + 1);
+				}
+				if (y + 1 < width) {
+					best = std::min<std::uint16_t>(best, next[y + 1] + 1);
+				}
+			}
+			row[y] = best;
+		}
+	}
+
+	return distance;
+}
+
 void DeepwaterGenerationPass::process_ocean_subchunk(
-	TileMap &tilemap, std::uint8_t chunk_x, std::uint8_t chunk_y,
+	TileMap &tilemap, const std::vector<std::uint16_t> &distance,
+	std::uint32_t radius, ChunkCoord chunk_x, ChunkCoord chunk_y,
 	SubChunkPos sub_pos
 ) {
+	const std::uint32_t width = tilemap.get_size() * Chunk::size;
+
 	// Get starting tile coordinates for this sub-chunk
 	auto [start_x, start_y] = subchunk_to_tile_start(sub_pos);
 
@@ -54,70 +129,24 @@ void DeepwaterGenerationPass::process_ocean_subchunk(
 			TilePos pos{chunk_x, chunk_y, local_x, local_y};
 
 			// Get the tile at this position
-			const Tile &tile = tilemap.get_tile(pos);
+			const Tile &tile = tilemap.get_tile_unchecked(pos);
 
 			// Only process water tiles
 			if (tile.base != BaseTileType::Water) {
 				continue;
 			}
 
-			// Check if this water tile is surrounded by water/deepwater within
-			// the specified radius
-			if (is_surrounded_by_water(tilemap, pos, deepwater_radius_)) {
+			// Deepwater requires all tiles within the radius to be water or
+			// deepwater, i.e. the nearest land must be farther away
+			auto [global_x, global_y] = pos.to_global();
+			if (distance[std::size_t(global_x) * width + global_y] > radius) {
 				// Replace water with deepwater
 				Tile new_tile = tile;
 				new_tile.base = BaseTileType::Deepwater;
-				tilemap.set_tile(pos, new_tile);
+				tilemap.set_tile_unchecked(pos, new_tile);
 			}
 		}
 	}
 }
 
-bool DeepwaterGenerationPass::is_surrounded_by_water(
-	const TileMap &tilemap, TilePos center_pos, std::uint32_t radius
-) const {
-	auto [center_global_x, center_global_y] = center_pos.to_global();
-	std::uint8_t map_size = tilemap.get_size();
-	std::uint32_t max_global_coord = map_size * Chunk::size;
-
-	// Check all tiles within the radius
-	for (std::int32_t dx = -static_cast<std::int32_t>(radius);
-	     dx <= static_cast<std::int32_t>(radius); ++dx) {
-		for (std::int32_t dy = -static_cast<std::int32_t>(radius);
-		     dy <= static_cast<std::int32_t>(radius); ++dy) {
-			std::int32_t check_x = static_cast<std::int32_t>(center_global_x)
-				+ dx;
-			std::int32_t check_y = static_cast<std::int32_t>(center_global_y)
-				+ dy;
-
-			// Check bounds
-			if (check_x < 0 || check_y < 0
-			    || check_x >= static_cast<std::int32_t>(max_global_coord)
-			    || check_y >= static_cast<std::int32_t>(max_global_coord)) {
-				// Out of bounds, consider as water
-				continue;
-			}
-
-			// Convert back to TilePos and check if it's water
-			TilePos check_pos = TilePos::from_global(
-				static_cast<std::uint16_t>(check_x),
-				static_cast<std::uint16_t>(check_y)
-			);
-
-			const Tile &check_tile = tilemap.get_tile(check_pos);
-			if (check_tile.base != BaseTileType::Water
-			    && check_tile.base != BaseTileType::Deepwater) {
-				return false; // Found non-water tile within radius
-			}
-		}
-	}
-
-	return true; // All tiles within radius are water or deepwater
-}
-
-void TerrainGenerator::deepwater_pass(TileMap &tilemap) {
-	DeepwaterGenerationPass pass(config_.deepwater_radius);
-	pass(tilemap);
-}
-
 } // namespace istd
@@ -2,10 +2,10 @@
 #include "tilemap/chunk.h"
 #include "tilemap/generation.h"
 #include "tilemap/noise.h"
+#include "tilemap/poisson_disk.h"
 #include "tilemap/xoroshiro.h"
 #include <algorithm>
 #include <queue>
-#include <random>
 #include <unordered_set>
 
 namespace istd {
@@ -13,7 +13,7 @@ namespace istd {
 MineralClusterGenerationPass::MineralClusterGenerationPass(
 	const GenerationConfig &config, Xoroshiro128PP rng, Xoroshiro128PP noise_rng
 )
-	: config_(config), rng_(rng), noise_(noise_rng) {}
+	: config_(config), rng_(rng), noise_(noise_rng, config.noise_backend) {}
 
 void MineralClusterGenerationPass::operator()(TileMap &tilemap) {
 	// Generate each mineral type with different densities
@@ -39,66 +39,45 @@ void MineralClusterGenerationPass::operator()(TileMap &tilemap) {
 std::vector<TilePos> MineralClusterGenerationPass::generate_mineral_centers(
 	const TileMap &tilemap, SurfaceTileType mineral_type, std::uint16_t density
 ) {
-	std::vector<TilePos> centers;
-	std::uint8_t map_size = tilemap.get_size();
-	std::uint32_t total_chunks = map_size * map_size;
+	ChunkCoord map_size = tilemap.get_size();
+	std::uint64_t total_chunks = std::uint64_t(map_size) * map_size;
 
 	// Calculate expected number of mineral clusters based on density
 	std::uint32_t expected_clusters = (total_chunks * density) / 255;
 
-	// Minimum distance between mineral clusters to ensure spacing
-	std::uint32_t min_distance = calculate_min_mineral_distance(density);
-
-	const std::uint32_t max_coord = map_size * Chunk::size - 1;
-
-	// Generate candidates with rejection sampling
-	std::uint32_t attempts = 0;
-	const std::uint32_t max_attempts = expected_clusters
-		* 64; // More attempts for sparse minerals
-	std::uniform_int_distribution<std::uint16_t> dist(0, max_coord);
-
-	while (centers.size() < expected_clusters && attempts < max_attempts) {
-		++attempts;
-
-		// Generate random position
-		const auto global_x = dist(rng_);
-		const auto global_y = dist(rng_);
+	// Only draw from mountain edge tiles that are still empty
+	auto candidates = collect_tiles(tilemap, [&](TilePos pos) {
+		return is_suitable_for_mineral(tilemap, pos);
+	});
 
-		TilePos candidate = TilePos::from_global(global_x, global_y);
-
-		// Check if position is suitable for minerals (mountain edge)
-		if (!is_suitable_for_mineral(tilemap, candidate)) {
-			continue;
-		}
-
-		// Check distance to existing mineral centers
-		auto distance_checker = [candidate, min_distance](TilePos existing) {
-			return candidate.sqr_distance_to(existing)
-				< (min_distance * min_distance);
-		};
-		if (std::ranges::any_of(centers, distance_checker)) {
-			continue;
-		}
+	// Minimum distance between mineral clusters to ensure spacing
+	PoissonDiskSampler sampler(
+		map_size, calculate_min_mineral_distance(density)
+	);
 
-		// Use base probability for mineral placement
+	// Use base probability for mineral placement
+	auto probability_checker = [&](TilePos candidate) {
+		auto [global_x, global_y] = tilemap.world_coords(candidate);
 		std::uint8_t sample = noise_.noise(
 			global_x, global_y,
 			static_cast<std::uint32_t>(
 				mineral_type
 			) // Use mineral type as seed variation
 		);
-		if (sample < config_.mineral_base_prob) {
-			centers.push_back(candidate);
-		}
-	}
+		return sample < config_.mineral_base_prob;
+	};
 
-	return centers;
+	// More attempts for sparse minerals
+	const std::uint32_t max_attempts = expected_clusters * 64;
+	return sampler.sample(
+		candidates, expected_clusters, max_attempts, rng_, probability_checker
+	);
 }
 
 void MineralClusterGenerationPass::generate_mineral_cluster(
 	TileMap &tilemap, TilePos center, SurfaceTileType mineral_type
 ) {
-	auto [global_x, global_y] = center.to_global();
+	auto [global_x, global_y] = tilemap.world_coords(center);
 
 	// Calculate cluster size using similar approach to oil
 	auto span = config_.mineral_cluster_max_size
@@ -135,12 +114,14 @@ void MineralClusterGenerationPass::generate_mineral_cluster(
 		TilePos current = candidates.front();
 		candidates.pop();
 
-		auto neighbors = tilemap.get_neighbors(current);
+		auto neighbors = tilemap.neighbors_of(current);
 		std::shuffle(neighbors.begin(), neighbors.end(), rng);
 
 		for (const auto neighbor : neighbors) {
 			// 40% chance to skip this neighbor (slightly less dense than oil)
-			auto [neighbor_global_x, neighbor_global_y] = neighbor.to_global();
+			auto [neighbor_global_x, neighbor_global_y] = tilemap.world_coords(
+				neighbor
+			);
 			auto sample = noise_.noise(
 				neighbor_global_x, neighbor_global_y,
 				0x3c73dde4
@@ -175,7 +156,7 @@ void MineralClusterGenerationPass::generate_mineral_cluster(
 
 	// Place minerals on all cluster tiles
 	for (const auto &pos : cluster_tiles) {
-		Tile &tile = tilemap.get_tile(pos);
+		Tile &tile = tilemap.get_tile_unchecked(pos);
 		tile.surface = mineral_type;
 	}
 }
@@ -183,7 +164,7 @@ void MineralClusterGenerationPass::generate_mineral_cluster(
 bool MineralClusterGenerationPass::is_suitable_for_mineral(
 	const TileMap &tilemap, TilePos pos
 ) const {
-	const Tile &tile = tilemap.get_tile(pos);
+	const Tile &tile = tilemap.get_tile_unchecked(pos);
 
 	// Minerals can only be placed on mountains with empty surface
 	if (tile.base != BaseTileType::Mountain
@@ -199,10 +180,8 @@ bool MineralClusterGenerationPass::is_mountain_edge(
 	const TileMap &tilemap, TilePos pos
 ) const {
 	// Check if this mountain tile has at least one non-mountain neighbor
-	auto neighbors = tilemap.get_neighbors(pos);
-
-	for (const auto neighbor_pos : neighbors) {
-		const Tile &neighbor_tile = tilemap.get_tile(neighbor_pos);
+	for (const auto neighbor_pos : tilemap.neighbors_of(pos)) {
+		const Tile &neighbor_tile = tilemap.get_tile_unchecked(neighbor_pos);
 		if (neighbor_tile.base != BaseTileType::Mountain) {
 			return true; // Found a non-mountain neighbor
 		}
@@ -226,13 +205,4 @@ std::uint32_t MineralClusterGenerationPass::calculate_min_mineral_distance(
 	return std::max(scaled_distance, 8u);
 }
 
-void TerrainGenerator::mineral_cluster_pass(TileMap &tilemap) {
-	auto rng = master_rng_;
-	master_rng_ = master_rng_.jump_96();
-	auto noise_rng = master_rng_;
-	master_rng_ = master_rng_.jump_96();
-	MineralClusterGenerationPass pass(config_, rng, noise_rng);
-	pass(tilemap);
-}
-
 } // namespace istd
\ No newline at end of file
@@ -3,10 +3,10 @@
 #include "tilemap/chunk.h"
 #include "tilemap/generation.h"
 #include "tilemap/noise.h"
+#include "tilemap/poisson_disk.h"
 #include "tilemap/xoroshiro.h"
 #include <algorithm>
 #include <queue>
-#include <random>
 #include <unordered_set>
 
 namespace istd {
@@ -14,7 +14,7 @@ namespace istd {
 OilGenerationPass::OilGenerationPass(
 	const GenerationConfig &config, Xoroshiro128PP rng, Xoroshiro128PP noise_rng
 )
-	: config_(config), rng_(rng), noise_(noise_rng) {}
+	: config_(config), rng_(rng), noise_(noise_rng, config.noise_backend) {}
 
 void OilGenerationPass::operator()(TileMap &tilemap) {
 	// Generate oil center positions using Poisson disk sampling
@@ -29,67 +29,50 @@ void OilGenerationPass::operator()(TileMap &tilemap) {
 std::vector<TilePos> OilGenerationPass::generate_oil_centers(
 	const TileMap &tilemap
 ) {
-	std::vector<TilePos> centers;
-	std::uint8_t map_size = tilemap.get_size();
-	std::uint32_t total_chunks = map_size * map_size;
+	ChunkCoord map_size = tilemap.get_size();
+	std::uint64_t total_chunks = std::uint64_t(map_size) * map_size;
 
 	// Calculate expected number of oil fields based on density (out of 255)
 	std::uint32_t expected_oil_fields = (total_chunks * config_.oil_density)
 		/ 255;
 
-	// Minimum distance between oil fields to ensure spacing
-	std::uint32_t min_distance = calculate_min_oil_distance();
-
-	// Use Poisson disk sampling approach
-	const std::uint32_t max_coord = map_size * Chunk::size - 1;
-
-	// Generate candidates with rejection sampling
-	// Avoid infinite loops
-	std::uint32_t attempts = 0;
-	const std::uint32_t max_attempts = expected_oil_fields * 32;
-	std::uniform_int_distribution<std::uint16_t> dist(0, max_coord);
-
-	while (centers.size() < expected_oil_fields && attempts < max_attempts) {
-		++attempts;
-
-		// Generate random position using xoroshiro
-		const auto global_x = dist(rng_);
-		const auto global_y = dist(rng_);
-
-		TilePos candidate = TilePos::from_global(global_x, global_y);
-
-		// Check if position is suitable for oil
-		if (!is_suitable_for_oil(tilemap, candidate)) {
-			continue;
+	// Only draw from tiles that can hold oil in a biome that accepts it
+	auto candidates = collect_tiles(tilemap, [&](TilePos pos) {
+		if (!is_suitable_for_oil(tilemap, pos)) {
+			return false;
 		}
+		const Chunk &chunk = tilemap.get_chunk_unchecked(
+			pos.chunk_x, pos.chunk_y
+		);
+		return get_biome_oil_preference(chunk.get_biome(pos)) > 0;
+	});
 
-		// Check distance to existing oil centers
-		auto distance_checker = [candidate, min_distance](TilePos existing) {
-			return candidate.sqr_distance_to(existing)
-				< (min_distance * min_distance);
-		};
-		if (std::ranges::any_of(centers, distance_checker)) {
-			continue;
-		}
-
-		// Apply biome preference
-		const Chunk &chunk = tilemap.get_chunk_of(candidate);
+	// Minimum distance between oil fields to ensure spacing
+	PoissonDiskSampler sampler(map_size, calculate_min_oil_distance());
 
+	// Apply biome preference
+	auto biome_checker = [&](TilePos candidate) {
+		const Chunk &chunk = tilemap.get_chunk_unchecked(
+			candidate.chunk_x, candidate.chunk_y
+		);
 		BiomeType biome = chunk.get_biome(candidate);
 		std::uint8_t biome_preference = get_biome_oil_preference(biome);
 
 		// Use integer probability check (0-255)
+		auto [global_x, global_y] = tilemap.world_coords(candidate);
 		std::uint8_t sample = noise_.noise(global_x, global_y);
-		if (sample < biome_preference) {
-			centers.push_back(candidate);
-		}
-	}
+		return sample < biome_preference;
+	};
 
-	return centers;
+	// Avoid infinite loops
+	const std::uint32_t max_attempts = expected_oil_fields * 32;
+	return sampler.sample(
+		candidates, expected_oil_fields, max_attempts, rng_, biome_checker
+	);
 }
 
 void OilGenerationPass::generate_oil_cluster(TileMap &tilemap, TilePos center) {
-	auto [global_x, global_y] = center.to_global();
+	auto [global_x, global_y] = tilemap.world_coords(center);
 
 	auto span = config_.oil_cluster_max_size - config_.oil_cluster_min_size;
 	auto cluster_size = config_.oil_cluster_min_size;
@@ -116,11 +99,13 @@ void OilGenerationPass::generate_oil_cluster(TileMap &tilemap, TilePos center) {
 		TilePos current = candidates.front();
 		candidates.pop();
 
-		auto neighbors = tilemap.get_neighbors(current);
+		auto neighbors = tilemap.neighbors_of(current);
 		std::shuffle(neighbors.begin(), neighbors.end(), rng);
 		for (const auto neighbor : neighbors) {
 			// 50% chance to skip this neighbor
-			auto [neighbor_global_x, neighbor_global_y] = neighbor.to_global();
+			auto [neighbor_global_x, neighbor_global_y] = tilemap.world_coords(
+				neighbor
+			);
 			auto sample = noise_.noise(
 				neighbor_global_x, neighbor_global_y,
 				0x2b52aaed // random seed
@@ -152,7 +137,7 @@ void OilGenerationPass::generate_oil_cluster(TileMap &tilemap, TilePos center) {
 
 	// Place oil on all cluster tiles
 	for (const auto &pos : cluster_tiles) {
-		Tile &tile = tilemap.get_tile(pos);
+		Tile &tile = tilemap.get_tile_unchecked(pos);
 		tile.surface = SurfaceTileType::Oil;
 	}
 }
@@ -160,7 +145,7 @@ void OilGenerationPass::generate_oil_cluster(TileMap &tilemap, TilePos center) {
 bool OilGenerationPass::is_suitable_for_oil(
 	const TileMap &tilemap, TilePos pos
 ) const {
-	const Tile &tile = tilemap.get_tile(pos);
+	const Tile &tile = tilemap.get_tile_unchecked(pos);
 
 	// Oil can only be placed on land or sand, and surface must be empty
 	return (tile.base == BaseTileType::Land || tile.base == BaseTileType::Sand)
@@ -198,13 +183,4 @@ std::uint32_t OilGenerationPass::calculate_min_oil_distance() const {
 	return base_distance * 255 / config_.oil_density;
 }
 
-void TerrainGenerator::oil_pass(TileMap &tilemap) {
-	auto rng = master_rng_;
-	master_rng_ = master_rng_.jump_96();
-	auto noise_rng = master_rng_;
-	master_rng_ = master_rng_.jump_96();
-	OilGenerationPass pass(config_, rng, noise_rng);
-	pass(tilemap);
-}
-
 } // namespace istd
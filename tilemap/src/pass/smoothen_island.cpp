@@ -1,23 +1,29 @@
 #include "tilemap/pass/smoothen_island.h"
 #include "tilemap/biome.h"
+#include "tilemap/connected_components.h"
 #include "tilemap/generation.h"
 #include "tilemap/tile.h"
 #include <algorithm>
-#include <queue>
 
 namespace istd {
 
 SmoothenIslandPass::SmoothenIslandPass(
 	const GenerationConfig &config, Xoroshiro128PP rng
 )
-	: config_(config), noise_(rng) {}
+	: config_(config), noise_(rng, config.noise_backend) {}
 
 void SmoothenIslandPass::operator()(TileMap &tilemap) {
-	remove_small_island(tilemap);
+	WorkerPool pool(1);
+	(*this)(tilemap, pool);
+}
+
+void SmoothenIslandPass::operator()(TileMap &tilemap, WorkerPool &pool) {
+	remove_small_island(tilemap, pool);
+	CellularAutomaton automaton;
 	for (int i = 1; i <= config_.island_smoothen_steps; ++i) {
-		smoothen_islands(tilemap, i);
+		smoothen_islands(tilemap, i, automaton, pool);
 	}
-	remove_small_island(tilemap);
+	remove_small_island(tilemap, pool);
 }
 
 bool SmoothenIslandPass::is_island_tile(const Tile &tile) const {
@@ -27,101 +33,29 @@ bool SmoothenIslandPass::is_island_tile(const Tile &tile) const {
 	);
 }
 
-void SmoothenIslandPass::remove_small_island(TileMap &tilemap) {
-	std::uint8_t map_size = tilemap.get_size();
-	std::vector<std::vector<bool>> visited(
-		map_size * Chunk::size, std::vector<bool>(map_size * Chunk::size, false)
-	);
-
-	for (std::uint8_t chunk_x = 0; chunk_x < map_size; ++chunk_x) {
-		for (std::uint8_t chunk_y = 0; chunk_y < map_size; ++chunk_y) {
-			for (std::uint8_t local_x = 0; local_x < Chunk::size; ++local_x) {
-				for (std::uint8_t local_y = 0; local_y < Chunk::size;
-				     ++local_y) {
-					TilePos pos{chunk_x, chunk_y, local_x, local_y};
-					auto [global_x, global_y] = pos.to_global();
-
-					// Skip if already visited
-					if (visited[global_x][global_y]) {
-						continue;
-					}
-
-					const Tile &tile = tilemap.get_tile(pos);
-					if (!is_island_tile(tile)) {
-						visited[global_x][global_y] = true;
-						continue;
-					}
-
-					// Find connected component of island tiles
-					std::vector<TilePos> component_positions;
-					std::uint32_t component_size = bfs_component_size(
-						tilemap, pos, visited, component_positions
-					);
-
-					// Check if this component touches the boundary
-					auto boundary_checker =
-						[&tilemap](const TilePos &component_pos) {
-						return tilemap.is_at_boundary(component_pos);
-					};
-					bool touches_boundary = std::ranges::any_of(
-						component_positions, boundary_checker
-					);
-
-					// Skip if it touches the boundary
-					if (touches_boundary) {
-						continue;
-					}
-
-					// If the component is too small, convert it to water
-					if (component_size <= config_.island_remove_threshold) {
-						for (const auto &island_pos : component_positions) {
-							Tile tile = tilemap.get_tile(island_pos);
-							tile.base = BaseTileType::Water;
-							tilemap.set_tile(island_pos, tile);
-						}
-					}
-				}
-			}
-		}
-	}
-}
-
-std::uint32_t SmoothenIslandPass::bfs_component_size(
-	TileMap &tilemap, TilePos start_pos,
-	std::vector<std::vector<bool>> &visited, std::vector<TilePos> &positions
+void SmoothenIslandPass::remove_small_island(
+	TileMap &tilemap, WorkerPool &pool
 ) {
-	std::queue<TilePos> queue;
-	queue.push(start_pos);
-
-	auto [start_global_x, start_global_y] = start_pos.to_global();
-	visited[start_global_x][start_global_y] = true;
-
-	std::uint32_t size = 0;
-	positions.clear();
-
-	while (!queue.empty()) {
-		TilePos current = queue.front();
-		queue.pop();
-		positions.push_back(current);
-		++size;
+	auto is_island = [this](Tile tile) {
+		return is_island_tile(tile);
+	};
+	auto labels = label_components(tilemap, is_island, true, pool);
 
-		// Check all neighbors
-		std::vector<TilePos> neighbors = tilemap.get_neighbors(current, true);
-		for (const auto neighbor : neighbors) {
-			auto [neighbor_global_x, neighbor_global_y] = neighbor.to_global();
-			if (visited[neighbor_global_x][neighbor_global_y]) {
-				continue;
-			}
+	for (const auto &component : labels.components) {
+		// Skip if it touches the boundary
+		if (component.touches_boundary) {
+			continue;
+		}
 
-			const Tile &neighbor_tile = tilemap.get_tile(neighbor);
-			if (is_island_tile(neighbor_tile)) {
-				visited[neighbor_global_x][neighbor_global_y] = true;
-				queue.push(neighbor);
+		// If the component is too small, convert it to water
+		if (component.size <= config_.island_remove_threshold) {
+			for (const auto &island_pos : labels.tiles_of(component)) {
+				Tile tile = tilemap.get_tile_unchecked(island_pos);
+				tile.base = BaseTileType::Water;
+				tilemap.set_tile_unchecked(island_pos, tile);
 			}
 		}
 	}
-
-	return size;
 }
 
 Tile SmoothenIslandPass::ca_tile(
@@ -178,98 +112,56 @@ Tile SmoothenIslandPass::ca_tile(
 	return tile;
 }
 
-void SmoothenIslandPass::smoothen_islands_subchunk(
-	TileMap &tilemap, std::uint8_t chunk_x, std::uint8_t chunk_y,
-	SubChunkPos sub_pos, std::uint32_t step_i,
-	std::vector<std::pair<TilePos, Tile>> &replacements
-) {
-	const auto &chunk = tilemap.get_chunk(chunk_x, chunk_y);
-	auto biome = chunk.get_biome(sub_pos);
-	auto biome_props = get_biome_properties(biome);
-	if (!biome_props.is_ocean) {
+Tile SmoothenIslandPass::smoothen_islands_tile(
+	const TileMap &tilemap, TilePos pos, Tile tile,
+	const CANeighborhood<true> &neighborhood, std::uint64_t noise_value
+) const {
+	const auto &chunk = tilemap.get_chunk_unchecked(pos.chunk_x, pos.chunk_y);
+	auto biome = chunk.get_biome(pos);
+	if (!get_biome_properties(biome).is_ocean) {
 		// Only process ocean biomes
-		return;
+		return tile;
 	}
 
-	auto [start_x, start_y] = subchunk_to_tile_start(sub_pos);
-	for (std::uint8_t local_x = start_x;
-	     local_x < start_x + Chunk::subchunk_size; ++local_x) {
-		for (std::uint8_t local_y = start_y;
-		     local_y < start_y + Chunk::subchunk_size; ++local_y) {
-			TilePos pos{chunk_x, chunk_y, local_x, local_y};
-
-			Tile tile = tilemap.get_tile(pos);
-
-			auto neighbors = tilemap.get_neighbors(pos, true);
-			if (neighbors.size() < 8) {
-				continue;
-			}
-
-			int adj_land = 0, adj_sand = 0, adj_water = 0;
-			for (auto neighbor : neighbors) {
-				const Tile &neighbor_tile = tilemap.get_tile(neighbor);
-				switch (neighbor_tile.base) {
-				case BaseTileType::Land:
-					++adj_land;
-					break;
-				case BaseTileType::Sand:
-					++adj_sand;
-					break;
-				case BaseTileType::Water:
-				case BaseTileType::Deepwater:
-				case BaseTileType::Ice:
-					++adj_water;
-					break;
-				default:
-					break; // Ignore other tile types
-				}
-			}
-
-			auto [global_x, global_y] = pos.to_global();
-			std::uint8_t rand = noise_.noise(global_x, global_y, step_i);
+	if (neighborhood.at_border()) {
+		return tile;
+	}
 
-			CACtx ctx{
-				biome, rand, adj_land, adj_sand, adj_water,
-			};
+	int adj_land = neighborhood.count(BaseTileType::Land);
+	int adj_sand = neighborhood.count(BaseTileType::Sand);
+	int adj_water = neighborhood.count(BaseTileType::Water)
+		+ neighborhood.count(BaseTileType::Deepwater)
+		+ neighborhood.count(BaseTileType::Ice);
 
-			Tile new_tile = ca_tile(pos, tile, ctx);
-			if (new_tile != tile) {
-				replacements.emplace_back(pos, new_tile);
-			}
-		}
-	}
+	std::uint8_t rand = noise_value;
 
-	for (auto [pos, new_tile] : replacements) {
-		tilemap.set_tile(pos, new_tile);
-	}
+	CACtx ctx{
+		biome, rand, adj_land, adj_sand, adj_water,
+	};
+	return ca_tile(pos, tile, ctx);
 }
 
 void SmoothenIslandPass::smoothen_islands(
-	TileMap &tilemap, std::uint32_t step_i
-) {
-	std::vector<std::pair<TilePos, Tile>> replacements;
-
-	for (std::uint8_t chunk_x = 0; chunk_x < tilemap.get_size(); ++chunk_x) {
-		for (std::uint8_t chunk_y = 0; chunk_y < tilemap.get_size();
-		     ++chunk_y) {
-			for (std::uint8_t sub_x = 0; sub_x < Chunk::subchunk_count;
-			     ++sub_x) {
-				for (std::uint8_t sub_y = 0; sub_y < Chunk::subchunk_count;
-				     ++sub_y) {
-					SubChunkPos sub_pos{sub_x, sub_y};
-					smoothen_islands_subchunk(
-						tilemap, chunk_x, chunk_y, sub_pos, step_i, replacements
-					);
-				}
-			}
+	TileMap &tilemap, std::uint32_t step_i, CellularAutomaton &automaton,
+	WorkerPool &pool
+) const {
+	auto rule = [this, &tilemap](
+		TilePos pos, Tile tile, const CANeighborhood<true> &neighborhood,
+		std::uint64_t sample
+	) {
+		return smoothen_islands_tile(tilemap, pos, tile, neighborhood, sample);
+	};
+	// Only ocean tiles that are not mountains can change
+	auto needs_sample = [&tilemap](TilePos pos, Tile tile) {
+		if (tile.base == BaseTileType::Mountain) {
+			return false;
 		}
-	}
-}
-
-void TerrainGenerator::smoothen_islands_pass(TileMap &tilemap) {
-	SmoothenIslandPass pass(config_, master_rng_);
-	master_rng_ = master_rng_.jump_96();
-	pass(tilemap);
+		const auto &chunk = tilemap.get_chunk_unchecked(
+			pos.chunk_x, pos.chunk_y
+		);
+		return get_biome_properties(chunk.get_biome(pos)).is_ocean;
+	};
+	automaton.step<true>(tilemap, rule, needs_sample, noise_, step_i, pool);
 }
 
 } // namespace istd
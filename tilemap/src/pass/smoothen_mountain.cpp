@@ -1,8 +1,7 @@
 #include "tilemap/pass/smoothen_mountain.h"
+#include "tilemap/connected_components.h"
 #include "tilemap/generation.h"
 #include <map>
-#include <queue>
-#include <ranges>
 #include <set>
 
 namespace istd {
@@ -10,67 +9,39 @@ namespace istd {
 SmoothenMountainsPass::SmoothenMountainsPass(
 	const GenerationConfig &config, Xoroshiro128PP rng
 )
-	: config_(config), noise_(rng) {}
+	: config_(config), noise_(rng, config.noise_backend) {}
 
 void SmoothenMountainsPass::operator()(TileMap &tilemap) {
-	remove_small_mountain(tilemap);
+	WorkerPool pool(1);
+	(*this)(tilemap, pool);
+}
+
+void SmoothenMountainsPass::operator()(TileMap &tilemap, WorkerPool &pool) {
+	remove_small_mountain(tilemap, pool);
+	CellularAutomaton automaton;
 	for (int i = 1; i <= config_.mountain_smoothen_steps; ++i) {
-		smoothen_mountains(tilemap, i);
+		smoothen_mountains(tilemap, i, automaton, pool);
 	}
-	remove_small_mountain(tilemap);
+	remove_small_mountain(tilemap, pool);
 }
 
-void SmoothenMountainsPass::remove_small_mountain(TileMap &tilemap) {
-	std::uint8_t map_size = tilemap.get_size();
-	std::vector<std::vector<bool>> visited(
-		map_size * Chunk::size, std::vector<bool>(map_size * Chunk::size, false)
-	);
-
-	for (std::uint8_t chunk_x = 0; chunk_x < map_size; ++chunk_x) {
-		for (std::uint8_t chunk_y = 0; chunk_y < map_size; ++chunk_y) {
-			for (std::uint8_t local_x = 0; local_x < Chunk::size; ++local_x) {
-				for (std::uint8_t local_y = 0; local_y < Chunk::size;
-				     ++local_y) {
-					TilePos pos{chunk_x, chunk_y, local_x, local_y};
-					auto [global_x, global_y] = pos.to_global();
-
-					// Skip if already visited
-					if (visited[global_x][global_y]) {
-						continue;
-					}
-
-					const Tile &tile = tilemap.get_tile(pos);
-					if (tile.base != BaseTileType::Mountain) {
-						visited[global_x][global_y] = true;
-						continue;
-					}
-
-					// Find connected component of mountains
-					std::vector<TilePos> component_positions;
-					std::uint32_t component_size = bfs_component_size(
-						tilemap, pos, visited, component_positions
-					);
-
-					// If the component touches the boundary, skip it
-					bool touches_boundary = false;
-					for (auto component_pos : component_positions) {
-						if (tilemap.is_at_boundary(component_pos)) {
-							touches_boundary = true;
-							break;
-						}
-					}
-
-					// Skip if it touches the boundary
-					if (touches_boundary) {
-						continue;
-					}
-
-					// If the component is too small, smooth it out
-					if (component_size <= config_.mountain_remove_threshold) {
-						demountainize(tilemap, component_positions);
-					}
-				}
-			}
+void SmoothenMountainsPass::remove_small_mountain(
+	TileMap &tilemap, WorkerPool &pool
+) {
+	auto is_mountain = [](Tile tile) {
+		return tile.base == BaseTileType::Mountain;
+	};
+	auto labels = label_components(tilemap, is_mountain, true, pool);
+
+	for (const auto &component : labels.components) {
+		// Skip if it touches the boundary
+		if (component.touches_boundary) {
+			continue;
+		}
+
+		// If the component is too small, smooth it out
+		if (component.size <= config_.mountain_remove_threshold) {
+			demountainize(tilemap, labels.tiles_of(component));
 		}
 	}
 }
@@ -82,12 +53,12 @@ void SmoothenMountainsPass::demountainize(
 	std::map<BaseTileType, int> type_count;
 	std::set<TilePos> unique_positions;
 	for (auto p : pos) {
-		auto neighbors = tilemap.get_neighbors(p, true);
+		auto neighbors = tilemap.neighbors_of<true>(p);
 		unique_positions.insert(neighbors.begin(), neighbors.end());
 	}
 
 	for (auto p : unique_positions) {
-		const Tile &tile = tilemap.get_tile(p);
+		const Tile &tile = tilemap.get_tile_unchecked(p);
 		if (tile.base != BaseTileType::Mountain) {
 			type_count[tile.base]++;
 		}
@@ -104,8 +75,8 @@ void SmoothenMountainsPass::demountainize(
 
 	// Step 2: Replace each mountain tile with a random type based on the counts
 	for (const auto &p : pos) {
-		Tile tile = tilemap.get_tile(p);
-		auto [global_x, global_y] = p.to_global();
+		Tile tile = tilemap.get_tile_unchecked(p);
+		auto [global_x, global_y] = tilemap.world_coords(p);
 		auto sample = noise_.noise(global_x, global_y);
 		int index = sample % total_count; // Not perfectly uniform, but works
 		                                  // for small counts
@@ -116,52 +87,14 @@ void SmoothenMountainsPass::demountainize(
 			}
 			index -= count;
 		}
-		tilemap.set_tile(p, tile);
-	}
-}
-
-std::uint32_t SmoothenMountainsPass::bfs_component_size(
-	TileMap &tilemap, TilePos start_pos,
-	std::vector<std::vector<bool>> &visited, std::vector<TilePos> &positions
-) {
-	std::queue<TilePos> queue;
-	queue.push(start_pos);
-
-	auto [start_global_x, start_global_y] = start_pos.to_global();
-	visited[start_global_x][start_global_y] = true;
-
-	std::uint32_t size = 0;
-	positions.clear();
-
-	while (!queue.empty()) {
-		TilePos current = queue.front();
-		queue.pop();
-		positions.push_back(current);
-		++size;
-
-		// Check all neighbors
-		std::vector<TilePos> neighbors = tilemap.get_neighbors(current, true);
-		for (const auto neighbor : neighbors) {
-			auto [neighbor_global_x, neighbor_global_y] = neighbor.to_global();
-			if (visited[neighbor_global_x][neighbor_global_y]) {
-				continue;
-			}
-
-			const Tile &neighbor_tile = tilemap.get_tile(neighbor);
-			if (neighbor_tile.base == BaseTileType::Mountain) {
-				visited[neighbor_global_x][neighbor_global_y] = true;
-				queue.push(neighbor);
-			}
-		}
+		tilemap.set_tile_unchecked(p, tile);
 	}
-
-	return size;
 }
 
-void SmoothenMountainsPass::smoothen_mountains_tile(
-	const TileMap &tilemap, TilePos pos, std::uint32_t step_i,
-	std::vector<std::pair<TilePos, Tile>> &replacements
-) {
+Tile SmoothenMountainsPass::smoothen_mountains_tile(
+	const TileMap &tilemap, TilePos pos, Tile tile,
+	const CANeighborhood<false> &neighborhood, std::uint32_t step_i
+) const {
 	struct CAConf {
 		int neighbor_count;
 		int fill_chance = 0;   // n / 16
@@ -178,77 +111,54 @@ void SmoothenMountainsPass::smoothen_mountains_tile(
         {4, 16, 0 }
 	};
 
-	auto [global_x, global_y] = pos.to_global();
-	auto neighbors = tilemap.get_neighbors(pos);
-
 	// Ignore if adjacent to the boundary
-	if (neighbors.size() < 4) {
-		return;
+	if (neighborhood.at_border()) {
+		return tile;
 	}
 
-	// Count neighboring mountains
-	int mountain_count = 0;
-	for (const auto &neighbor : neighbors) {
-		const Tile &tile = tilemap.get_tile(neighbor);
-		if (tile.base == BaseTileType::Mountain) {
-			mountain_count += 1;
-		}
-	}
-
-	// Get the configuration for this count
+	// Get the configuration for the number of neighboring mountains
+	int mountain_count = neighborhood.count(BaseTileType::Mountain);
 	const CAConf &conf = cellularAutomataConfigurations[mountain_count];
+	auto [global_x, global_y] = tilemap.world_coords(pos);
 	auto sample = noise_.noise(global_x, global_y, step_i);
 	auto rd = sample & 0xF;
 	auto sel = sample >> 4;
 
-	Tile tile = tilemap.get_tile(pos);
 	if (tile.base == BaseTileType::Mountain && conf.remove_chance > rd) {
-		auto filterer = [&tilemap](const TilePos &p) {
-			auto neighbor_tile = tilemap.get_tile(p);
-			return neighbor_tile.base != BaseTileType::Mountain;
-		};
-		auto non_mountain_neighbors = neighbors | std::views::filter(filterer)
-			| std::ranges::to<std::vector>();
-
-		if (!non_mountain_neighbors.empty()) {
-			auto n = non_mountain_neighbors.size();
-			auto replacement = non_mountain_neighbors[sel % n];
-			tile.base = tilemap.get_tile(replacement).base;
-			replacements.emplace_back(pos, tile);
+		int n = neighborhood.size - mountain_count;
+		if (n == 0) {
+			return tile;
 		}
-	} else if (tile.base != BaseTileType::Mountain && conf.fill_chance > rd) {
-		tile.base = BaseTileType::Mountain;
-		replacements.emplace_back(pos, tile);
-	}
-}
 
-void SmoothenMountainsPass::smoothen_mountains(
-	TileMap &tilemap, std::uint32_t step_i
-) {
-	std::vector<std::pair<TilePos, Tile>> replacements;
-
-	for (std::uint8_t chunk_x = 0; chunk_x < tilemap.get_size(); ++chunk_x) {
-		for (std::uint8_t chunk_y = 0; chunk_y < tilemap.get_size();
-		     ++chunk_y) {
-			for (std::uint8_t local_x = 0; local_x < Chunk::size; ++local_x) {
-				for (std::uint8_t local_y = 0; local_y < Chunk::size;
-				     ++local_y) {
-					TilePos pos{chunk_x, chunk_y, local_x, local_y};
-					smoothen_mountains_tile(tilemap, pos, step_i, replacements);
-				}
+		// Pick the (sel % n)-th non-mountain neighbor as replacement
+		int index = sel % n;
+		for (const Tile &neighbor_tile : neighborhood.tiles) {
+			if (neighbor_tile.base == BaseTileType::Mountain) {
+				continue;
+			}
+			if (index-- == 0) {
+				tile.base = neighbor_tile.base;
+				break;
 			}
 		}
+	} else if (tile.base != BaseTileType::Mountain && conf.fill_chance > rd) {
+		tile.base = BaseTileType::Mountain;
 	}
-
-	for (const auto &[pos, new_tile] : replacements) {
-		tilemap.set_tile(pos, new_tile);
-	}
+	return tile;
 }
 
-void TerrainGenerator::smoothen_mountains_pass(TileMap &tilemap) {
-	SmoothenMountainsPass pass(config_, master_rng_);
-	master_rng_ = master_rng_.jump_96();
-	pass(tilemap);
+void SmoothenMountainsPass::smoothen_mountains(
+	TileMap &tilemap, std::uint32_t step_i, CellularAutomaton &automaton,
+	WorkerPool &pool
+) const {
+	auto rule = [this, &tilemap, step_i](
+		TilePos pos, Tile tile, const CANeighborhood<false> &neighborhood
+	) {
+		return smoothen_mountains_tile(
+			tilemap, pos, tile, neighborhood, step_i
+		);
+	};
+	automaton.step<false>(tilemap, rule, pool);
 }
 
 } // namespace istd
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include "tilemap/pipeline.h"
+#include "tilemap/generation.h"
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+
+namespace istd {
+
+namespace {
+
+// Count the tiles and sub-chunk biomes that differ between two maps of the
+// same size
+void count_changes(
+	const TileMap &before, const TileMap &after, PassReport &report
+) {
+	const ChunkCoord map_size = after.get_size();
+	for (ChunkCoord chunk_x = 0; chunk_x < map_size; ++chunk_x) {
+		for (ChunkCoord chunk_y = 0; chunk_y < map_size; ++chunk_y) {
+			const Chunk &old_chunk = before.get_chunk_unchecked(
+				chunk_x, chunk_y
+			);
+			const Chunk &new_chunk = after.get_chunk_unchecked(
+				chunk_x, chunk_y
+			);
+			for (std::uint8_t x = 0; x < Chunk::size; ++x) {
+				for (std::uint8_t y = 0; y < Chunk::size; ++y) {
+					report.tiles_written += old_chunk.tiles[x][y]
+						!= new_chunk.tiles[x][y];
+				}
+			}
+			for (std::uint8_t x = 0; x < Chunk::subchunk_count; ++x) {
+				for (std::uint8_t y = 0; y < Chunk::subchunk_count; ++y) {
+					report.biomes_written += old_chunk.biome[x][y]
+						!= new_chunk.biome[x][y];
+				}
+			}
+		}
+	}
+}
+
+} // namespace
+
+std::chrono::nanoseconds PipelineReport::total_wall_time() const {
+	std::chrono::nanoseconds total{0};
+	for (const PassReport &pass : passes) {
+		total += pass.wall_time;
+	}
+	return total;
+}
+
+const PassReport *PipelineReport::find(std::string_view name) const {
+	auto it = std::ranges::find(passes, name, &PassReport::name);
+	return it == passes.end() ? nullptr : &*it;
+}
+
+const CompactTileMap *PassSnapshotCache::find(
+	std::string_view pass, std::uint64_t key
+) const {
+	auto it = snapshots_.find(pass);
+	if (it == snapshots_.end() || it->second.key != key) {
+		return nullptr;
+	}
+	return &it->second.tilemap;
+}
+
+void PassSnapshotCache::store(
+	std::string_view pass, std::uint64_t key, const TileMap &tilemap
+) {
+	auto it = snapshots_.find(pass);
+	if (it == snapshots_.end()) {
+		snapshots_.emplace(
+			std::string(pass), Snapshot{key, CompactTileMap(tilemap)}
+		);
+		return;
+	}
+	it->second.key = key;
+	it->second.tilemap = CompactTileMap(tilemap);
+}
+
+void GenerationPipeline::add_pass(
+	std::string name, std::uint32_t rng_streams, PassFunction run,
+	ConfigHashFunction hash_config
+) {
+	if (std::ranges::find(stages_, name, &Stage::name) != stages_.end()) {
+		throw std::invalid_argument("Duplicate generation pass: " + name);
+	}
+	stages_.push_back({
+		std::move(name), rng_streams, std::move(run), std::move(hash_config)
+	});
+}
+
+std::vector<std::string_view> GenerationPipeline::pass_names() const {
+	std::vector<std::string_view> names;
+	names.reserve(stages_.size());
+	for (const Stage &stage : stages_) {
+		names.push_back(stage.name);
+	}
+	return names;
+}
+
+std::vector<std::uint64_t> GenerationPipeline::stage_keys(
+	const GenerationConfig &config, ChunkCoord map_size, ChunkCoord origin_x,
+	ChunkCoord origin_y
+) const {
+	// Each key extends the previous one, so it covers all upstream inputs
+	StableHasher hasher;
+	hasher.add(config.seed, map_size, origin_x, origin_y);
+
+	std::vector<std::uint64_t> keys;
+	keys.reserve(stages_.size());
+	for (const Stage &stage : stages_) {
+		hasher.add(std::string_view(stage.name));
+		hasher.add(stage.rng_streams);
+		if (stage.hash_config) {
+			stage.hash_config(hasher, config);
+		}
+		keys.push_back(hasher.value());
+	}
+	return keys;
+}
+
+PipelineReport GenerationPipeline::run(
+	TileMap &tilemap, const GenerationConfig &config, WorkerPool &pool,
+	PassSnapshotCache *snapshots
+) const {
+	using clock = std::chrono::steady_clock;
+
+	PipelineReport report;
+	report.allocations_measured = allocation_probe_ != nullptr;
+	report.writes_counted = count_writes_;
+	report.passes.reserve(stages_.size());
+
+	// Passes write through references and from worker threads, which would
+	// leave the layers stale or race on their shared words, so drop them for
+	// the run and rebuild them once at the end
+	const bool layers_enabled = tilemap.has_layers();
+	tilemap.disable_layers();
+
+	// Passes write from worker threads, which must not allocate chunks
+	if (tilemap.allocation() == ChunkAllocation::OnDemand) {
+		for (ChunkCoord chunk_x = 0; chunk_x < tilemap.get_size(); ++chunk_x) {
+			for (ChunkCoord chunk_y = 0; chunk_y < tilemap.get_size();
+			     ++chunk_y) {
+				tilemap.get_chunk_unchecked(chunk_x, chunk_y);
+			}
+		}
+	}
+
+	// Resume after the last pass with an up-to-date snapshot
+	std::vector<std::uint64_t> keys;
+	std::size_t resume = 0;
+	if (snapshots) {
+		keys = stage_keys(
+			config, tilemap.get_size(), tilemap.origin_x(), tilemap.origin_y()
+		);
+		for (std::size_t i = stages_.size(); i-- > 0;) {
+			const CompactTileMap *snapshot = snapshots->find(
+				stages_[i].name, keys[i]
+			);
+			if (snapshot) {
+				snapshot->decompress(tilemap);
+				resume = i + 1;
+				break;
+			}
+		}
+	}
+
+	Xoroshiro128PP master_rng(config.seed);
+	std::vector<Xoroshiro128PP> rngs;
+	// Copy of the map before the current pass, only kept to count writes
+	std::optional<TileMap> before;
+	for (std::size_t stage_i = 0; stage_i < stages_.size(); ++stage_i) {
+		const Stage &stage = stages_[stage_i];
+		rngs.clear();
+		for (std::uint32_t i = 0; i < stage.rng_streams; ++i) {
+			rngs.push_back(master_rng);
+			master_rng = master_rng.jump_96();
+		}
+
+		PassReport &pass = report.passes.emplace_back();
+		pass.name = stage.name;
+		if (stage_i < resume) {
+			pass.restored = true;
+			continue;
+		}
+
+		if (count_writes_) {
+			before = tilemap;
+		}
+		AllocationStats allocations_before;
+		if (allocation_probe_) {
+			allocations_before = allocation_probe_();
+		}
+		auto start = clock::now();
+		stage.run(tilemap, {config, pool, rngs});
+		pass.wall_time = clock::now() - start;
+		if (allocation_probe_) {
+			AllocationStats allocations_after = allocation_probe_();
+			pass.allocations.count = allocations_after.count
+				- allocations_before.count;
+			pass.allocations.bytes = allocations_after.bytes
+				- allocations_before.bytes;
+		}
+
+		if (before) {
+			count_changes(*before, tilemap, pass);
+		}
+		if (snapshots) {
+			snapshots->store(stage.name, keys[stage_i], tilemap);
+		}
+	}
+
+	if (layers_enabled) {
+		tilemap.enable_layers();
+	}
+	return report;
+}
+
+} // namespace istd
@@ -0,0 +1,55 @@
+#include "tilemap/poisson_disk.h"
+#include <algorithm>
+
+namespace istd {
+
+PoissonDiskSampler::PoissonDiskSampler(
+	ChunkCoord map_size, std::uint32_t min_distance
+)
+	: min_distance_(min_distance) {
+	// floor(d / sqrt(2)) keeps the cell diagonal below the minimum distance
+	cell_size_ = std::max<std::uint32_t>(
+		static_cast<std::uint32_t>(min_distance * 0.70710678118654752), 1
+	);
+	reach_ = (min_distance + cell_size_ - 1) / cell_size_;
+
+	const std::uint32_t map_width = map_size * Chunk::size;
+	grid_width_ = (map_width + cell_size_ - 1) / cell_size_;
+	grid_.assign(std::size_t(grid_width_) * grid_width_, empty_cell);
+}
+
+bool PoissonDiskSampler::is_far_enough(TilePos pos) const {
+	if (min_distance_ == 0) {
+		return true;
+	}
+
+	auto [global_x, global_y] = pos.to_global();
+	const std::uint32_t cell_x = cell_of(global_x);
+	const std::uint32_t cell_y = cell_of(global_y);
+	const std::uint32_t x_begin = cell_x - std::min(cell_x, reach_);
+	const std::uint32_t y_begin = cell_y - std::min(cell_y, reach_);
+	const std::uint32_t x_end = std::min(cell_x + reach_ + 1, grid_width_);
+	const std::uint32_t y_end = std::min(cell_y + reach_ + 1, grid_width_);
+
+	const std::uint64_t sqr_min_distance = std::uint64_t(min_distance_)
+		* min_distance_;
+	for (std::uint32_t x = x_begin; x < x_end; ++x) {
+		for (std::uint32_t y = y_begin; y < y_end; ++y) {
+			const std::uint32_t index = grid_[std::size_t(x) * grid_width_ + y];
+			if (index != empty_cell
+			    && pos.sqr_distance_to(points_[index]) < sqr_min_distance) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void PoissonDiskSampler::insert(TilePos pos) {
+	auto [global_x, global_y] = pos.to_global();
+	grid_[std::size_t(cell_of(global_x)) * grid_width_ + cell_of(global_y)]
+		= points_.size();
+	points_.push_back(pos);
+}
+
+} // namespace istd
@@ -0,0 +1,26 @@
+#include "tilemap/tile_layers.h"
+
+namespace istd {
+
+void ChunkLayers::rebuild(const Chunk &chunk) noexcept {
+	for (std::size_t layer = 0; layer < tile_layer_count; ++layer) {
+		for (std::uint8_t x = 0; x < Chunk::size; ++x) {
+			std::uint64_t row = 0;
+			for (std::uint8_t y = 0; y < Chunk::size; ++y) {
+				const bool set = is_in_layer(
+					static_cast<TileLayer>(layer), chunk.tiles[x][y]
+				);
+				row |= std::uint64_t(set) << y;
+			}
+			rows[layer][x] = row;
+		}
+		for (std::uint8_t sub_x = 0; sub_x < Chunk::subchunk_count; ++sub_x) {
+			for (std::uint8_t sub_y = 0; sub_y < Chunk::subchunk_count;
+			     ++sub_y) {
+				update_subchunk(layer, sub_x, sub_y);
+			}
+		}
+	}
+}
+
+} // namespace istd
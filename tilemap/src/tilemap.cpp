@@ -1,35 +1,268 @@
 #include "tilemap/tilemap.h"
 #include "tilemap/chunk.h"
+#include "tilemap/mapped_file.h"
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
 
 namespace istd {
 
-TileMap::TileMap(std::uint8_t size): size_(size) {
-	if (size == 0 || size > 100) {
-		throw std::invalid_argument("TileMap size must be between 1 and 100");
+const Chunk TileMap::empty_chunk_{};
+
+const ChunkLayers TileMap::empty_layers_ = [] {
+	ChunkLayers layers;
+	layers.rebuild(empty_chunk_);
+	return layers;
+}();
+
+TileMap::TileMap(ChunkCoord size, ChunkAllocation allocation): size_(size) {
+	if (size == 0) {
+		throw std::invalid_argument("TileMap size must be between 1 and 65535");
+	}
+
+	if (allocation == ChunkAllocation::OnDemand) {
+		const std::size_t pages_per_side = (size + page_side - 1) / page_side;
+		pages_.resize(pages_per_side * pages_per_side);
+		return;
+	}
+
+	// Allocate all chunks in one contiguous block
+	heap_chunks_.resize(static_cast<std::size_t>(size) * size);
+	contiguous_ = heap_chunks_.data();
+}
+
+TileMap::TileMap(
+	ChunkCoord size, std::shared_ptr<MappedFile> mapping,
+	std::size_t chunk_offset
+)
+	: size_(size), mapping_(std::move(mapping)) {
+	if (size == 0) {
+		throw std::invalid_argument("TileMap size must be between 1 and 65535");
 	}
 
-	// Initialize the 2D vector of chunks
-	chunks_.resize(size);
-	for (auto &row : chunks_) {
-		row.resize(size);
+	const auto bytes = mapping_->bytes();
+	const std::size_t chunk_bytes = sizeof(Chunk) * size * size;
+	if (chunk_offset > bytes.size()
+	    || bytes.size() - chunk_offset < chunk_bytes) {
+		throw std::invalid_argument("Mapped file is too small for the chunks");
 	}
+	static_assert(alignof(Chunk) == 1);
+	contiguous_ = reinterpret_cast<Chunk *>(bytes.data() + chunk_offset);
 }
 
-Chunk &TileMap::get_chunk(std::uint8_t chunk_x, std::uint8_t chunk_y) {
+TileMap::TileMap(const TileMap &other)
+	: size_(other.size_)
+	, origin_x_(other.origin_x_)
+	, origin_y_(other.origin_y_)
+	, pages_(other.pages_.size()) {
+	if (other.contiguous_) {
+		heap_chunks_.assign(other.chunks().begin(), other.chunks().end());
+		contiguous_ = heap_chunks_.data();
+		heap_layers_ = other.heap_layers_;
+		layers_enabled_ = other.layers_enabled_;
+		return;
+	}
+
+	// Copy only the allocated chunks
+	const std::size_t pages_per_side = (size_ + page_side - 1) / page_side;
+	for (std::size_t page_i = 0; page_i < other.pages_.size(); ++page_i) {
+		if (!other.pages_[page_i]) {
+			continue;
+		}
+		const auto &chunks = other.pages_[page_i]->chunks;
+		for (std::size_t slot = 0; slot < chunks.size(); ++slot) {
+			if (chunks[slot]) {
+				get_chunk_unchecked(
+					page_i / pages_per_side * page_side + slot / page_side,
+					page_i % pages_per_side * page_side + slot % page_side
+				) = *chunks[slot];
+			}
+		}
+	}
+	if (other.layers_enabled_) {
+		enable_layers();
+	}
+}
+
+TileMap &TileMap::operator=(const TileMap &other) {
+	if (this == &other) {
+		return *this;
+	}
+	if (size_ == other.size_ && contiguous_) {
+		origin_x_ = other.origin_x_;
+		origin_y_ = other.origin_y_;
+		if (other.contiguous_) {
+			std::ranges::copy(other.chunks(), contiguous_);
+		} else {
+			for (ChunkCoord chunk_x = 0; chunk_x < size_; ++chunk_x) {
+				for (ChunkCoord chunk_y = 0; chunk_y < size_; ++chunk_y) {
+					get_chunk_unchecked(chunk_x, chunk_y)
+						= other.get_chunk_unchecked(chunk_x, chunk_y);
+				}
+			}
+		}
+		if (layers_enabled_) {
+			enable_layers();
+		}
+		return *this;
+	}
+
+	// Layers stay enabled or disabled as they were on this map
+	const bool layers_enabled = layers_enabled_;
+	*this = TileMap(other);
+	if (layers_enabled && !layers_enabled_) {
+		enable_layers();
+	} else if (!layers_enabled && layers_enabled_) {
+		disable_layers();
+	}
+	return *this;
+}
+
+TileMap::TileMap(TileMap &&other) noexcept
+	: size_(std::exchange(other.size_, 0))
+	, origin_x_(other.origin_x_)
+	, origin_y_(other.origin_y_)
+	, contiguous_(std::exchange(other.contiguous_, nullptr))
+	, heap_chunks_(std::move(other.heap_chunks_))
+	, mapping_(std::move(other.mapping_))
+	, pages_(std::move(other.pages_))
+	, sparse_chunks_(std::move(other.sparse_chunks_))
+	, layers_enabled_(std::exchange(other.layers_enabled_, false))
+	, heap_layers_(std::move(other.heap_layers_))
+	, sparse_layers_(std::move(other.sparse_layers_)) {}
+
+TileMap &TileMap::operator=(TileMap &&other) noexcept {
+	size_ = std::exchange(other.size_, 0);
+	origin_x_ = other.origin_x_;
+	origin_y_ = other.origin_y_;
+	contiguous_ = std::exchange(other.contiguous_, nullptr);
+	heap_chunks_ = std::move(other.heap_chunks_);
+	mapping_ = std::move(other.mapping_);
+	pages_ = std::move(other.pages_);
+	sparse_chunks_ = std::move(other.sparse_chunks_);
+	layers_enabled_ = std::exchange(other.layers_enabled_, false);
+	heap_layers_ = std::move(other.heap_layers_);
+	sparse_layers_ = std::move(other.sparse_layers_);
+	return *this;
+}
+
+Chunk &TileMap::allocate_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y) {
+	const std::size_t pages_per_side = (size_ + page_side - 1) / page_side;
+	auto &page = pages_[
+		(chunk_x / page_side) * pages_per_side + chunk_y / page_side
+	];
+	if (!page) {
+		page = std::make_unique<DirectoryPage>();
+	}
+	Chunk &chunk = sparse_chunks_.emplace_back();
+	page->chunks[page_slot(chunk_x, chunk_y)] = &chunk;
+	if (layers_enabled_) {
+		page->layers[page_slot(chunk_x, chunk_y)]
+			= &sparse_layers_.emplace_back(empty_layers_);
+	}
+	return chunk;
+}
+
+void TileMap::enable_layers() {
+	layers_enabled_ = true;
+	if (contiguous_) {
+		heap_layers_.resize(chunks().size());
+		for (std::size_t i = 0; i < heap_layers_.size(); ++i) {
+			heap_layers_[i].rebuild(contiguous_[i]);
+		}
+		return;
+	}
+
+	for (const auto &page : pages_) {
+		if (!page) {
+			continue;
+		}
+		for (std::size_t slot = 0; slot < page->chunks.size(); ++slot) {
+			if (!page->chunks[slot]) {
+				continue;
+			}
+			ChunkLayers *&layers = page->layers[slot];
+			if (!layers) {
+				layers = &sparse_layers_.emplace_back();
+			}
+			layers->rebuild(*page->chunks[slot]);
+		}
+	}
+}
+
+void TileMap::disable_layers() noexcept {
+	layers_enabled_ = false;
+	heap_layers_ = {};
+	sparse_layers_.clear();
+	for (const auto &page : pages_) {
+		if (page) {
+			page->layers.fill(nullptr);
+		}
+	}
+}
+
+bool TileMap::any_in_layer_row(
+	TileLayer layer, GlobalCoord global_x, GlobalCoord global_y,
+	GlobalCoord length
+) const noexcept {
+	const ChunkCoord chunk_x = global_x / Chunk::size;
+	const std::uint8_t local_x = global_x % Chunk::size;
+	while (length > 0) {
+		const ChunkCoord chunk_y = global_y / Chunk::size;
+		const unsigned first = global_y % Chunk::size;
+		const unsigned count = std::min<GlobalCoord>(
+			length, Chunk::size - first
+		);
+
+		if (!layers_enabled_) {
+			const Chunk &chunk = get_chunk_unchecked(chunk_x, chunk_y);
+			for (unsigned y = first; y < first + count; ++y) {
+				if (is_in_layer(layer, chunk.tiles[local_x][y])) {
+					return true;
+				}
+			}
+		} else {
+			const std::uint64_t mask = ~std::uint64_t(0)
+				>> (Chunk::size - count) << first;
+			if (find_layers(chunk_x, chunk_y).row(layer, local_x) & mask) {
+				return true;
+			}
+		}
+		global_y += count;
+		length -= count;
+	}
+	return false;
+}
+
+void TileMap::set_origin(ChunkCoord origin_x, ChunkCoord origin_y) {
+	if (origin_x > max_size - size_ || origin_y > max_size - size_) {
+		throw std::invalid_argument("TileMap origin is outside the world");
+	}
+	origin_x_ = origin_x;
+	origin_y_ = origin_y;
+}
+
+bool TileMap::has_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y) const {
 	if (chunk_x >= size_ || chunk_y >= size_) {
 		throw std::out_of_range("Chunk coordinates out of bounds");
 	}
-	return chunks_[chunk_x][chunk_y];
+	return contiguous_ || find_chunk(chunk_x, chunk_y);
+}
+
+Chunk &TileMap::get_chunk(ChunkCoord chunk_x, ChunkCoord chunk_y) {
+	if (chunk_x >= size_ || chunk_y >= size_) {
+		throw std::out_of_range("Chunk coordinates out of bounds");
+	}
+	return get_chunk_unchecked(chunk_x, chunk_y);
 }
 
 const Chunk &TileMap::get_chunk(
-	std::uint8_t chunk_x, std::uint8_t chunk_y
+	ChunkCoord chunk_x, ChunkCoord chunk_y
 ) const {
 	if (chunk_x >= size_ || chunk_y >= size_) {
 		throw std::out_of_range("Chunk coordinates out of bounds");
 	}
-	return chunks_[chunk_x][chunk_y];
+	return get_chunk_unchecked(chunk_x, chunk_y);
 }
 
 Chunk &TileMap::get_chunk_of(TilePos pos) {
@@ -47,7 +280,7 @@ Tile &TileMap::get_tile(TilePos pos) {
 	if (pos.local_x >= Chunk::size || pos.local_y >= Chunk::size) {
 		throw std::out_of_range("Local coordinates out of bounds");
 	}
-	return chunks_[pos.chunk_x][pos.chunk_y].tiles[pos.local_x][pos.local_y];
+	return get_tile_unchecked(pos);
 }
 
 const Tile &TileMap::get_tile(TilePos pos) const {
@@ -57,7 +290,7 @@ const Tile &TileMap::get_tile(TilePos pos) const {
 	if (pos.local_x >= Chunk::size || pos.local_y >= Chunk::size) {
 		throw std::out_of_range("Local coordinates out of bounds");
 	}
-	return chunks_[pos.chunk_x][pos.chunk_y].tiles[pos.local_x][pos.local_y];
+	return get_tile_unchecked(pos);
 }
 
 void TileMap::set_tile(TilePos pos, const Tile &tile) {
@@ -67,11 +300,11 @@ void TileMap::set_tile(TilePos pos, const Tile &tile) {
 	if (pos.local_x >= Chunk::size || pos.local_y >= Chunk::size) {
 		throw std::out_of_range("Local coordinates out of bounds");
 	}
-	chunks_[pos.chunk_x][pos.chunk_y].tiles[pos.local_x][pos.local_y] = tile;
+	set_tile_unchecked(pos, tile);
 }
 
 bool TileMap::is_at_boundary(TilePos pos) const {
-	std::uint8_t map_size = get_size();
+	ChunkCoord map_size = get_size();
 	std::uint32_t global_x = pos.chunk_x * Chunk::size + pos.local_x;
 	std::uint32_t global_y = pos.chunk_y * Chunk::size + pos.local_y;
 	std::uint32_t max_global = map_size * Chunk::size - 1;
@@ -81,29 +314,13 @@ bool TileMap::is_at_boundary(TilePos pos) const {
 }
 
 std::vector<TilePos> TileMap::get_neighbors(TilePos pos, bool chebyshiv) const {
-	std::vector<TilePos> neighbors;
-	std::uint8_t map_size = get_size();
-
-	auto [global_x, global_y] = pos.to_global();
-	int max_global = map_size * Chunk::size - 1;
-
-	// Four cardinal directions
-	const int dx[] = {-1, 1, 0, 0, -1, 1, -1, 1};
-	const int dy[] = {0, 0, -1, 1, -1, -1, 1, 1};
-	for (int i = 0; i < (chebyshiv ? 8 : 4); ++i) {
-		int new_global_x = global_x + dx[i];
-		int new_global_y = global_y + dy[i];
-
-		// Check bounds
-		if (new_global_x >= 0 && new_global_x <= max_global && new_global_y >= 0
-		    && new_global_y <= max_global) {
-			neighbors.push_back(
-				TilePos::from_global(new_global_x, new_global_y)
-			);
-		}
+	if (chebyshiv) {
+		auto neighbors = neighbors_of<true>(pos);
+		return {neighbors.begin(), neighbors.end()};
 	}
 
-	return neighbors;
+	auto neighbors = neighbors_of<false>(pos);
+	return {neighbors.begin(), neighbors.end()};
 }
 
 } // namespace istd
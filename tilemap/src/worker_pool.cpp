@@ -0,0 +1,90 @@
+#include "tilemap/worker_pool.h"
+#include <algorithm>
+
+namespace istd {
+
+WorkerPool::WorkerPool(std::uint32_t threads) {
+	threads = std::max<std::uint32_t>(threads, 1);
+	workers_.reserve(threads - 1);
+	for (std::uint32_t i = 1; i < threads; ++i) {
+		workers_.emplace_back([this] {
+			worker_loop();
+		});
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard lock(mutex_);
+		stopping_ = true;
+	}
+	wake_cv_.notify_all();
+	// std::jthread joins on destruction
+}
+
+void WorkerPool::run_indices(
+	const std::function<void(std::uint32_t)> &job, std::uint32_t count
+) {
+	for (std::uint32_t i = next_index_.fetch_add(1); i < count;
+	     i = next_index_.fetch_add(1)) {
+		job(i);
+	}
+}
+
+void WorkerPool::worker_loop() {
+	std::uint64_t seen_generation = 0;
+	while (true) {
+		const std::function<void(std::uint32_t)> *job;
+		std::uint32_t count;
+		{
+			std::unique_lock lock(mutex_);
+			wake_cv_.wait(lock, [&] {
+				return stopping_ || generation_ != seen_generation;
+			});
+			if (stopping_) {
+				return;
+			}
+			seen_generation = generation_;
+			job = job_;
+			count = job_count_;
+		}
+
+		run_indices(*job, count);
+
+		std::lock_guard lock(mutex_);
+		if (--busy_workers_ == 0) {
+			done_cv_.notify_one();
+		}
+	}
+}
+
+void WorkerPool::parallel_for(
+	std::uint32_t count, const std::function<void(std::uint32_t)> &job
+) {
+	if (workers_.empty() || count <= 1) {
+		for (std::uint32_t i = 0; i < count; ++i) {
+			job(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard lock(mutex_);
+		job_ = &job;
+		job_count_ = count;
+		next_index_.store(0);
+		busy_workers_ = workers_.size();
+		++generation_;
+	}
+	wake_cv_.notify_all();
+
+	run_indices(job, count);
+
+	std::unique_lock lock(mutex_);
+	done_cv_.wait(lock, [this] {
+		return busy_workers_ == 0;
+	});
+	job_ = nullptr;
+}
+
+} // namespace istd
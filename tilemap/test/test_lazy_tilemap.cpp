@@ -0,0 +1,109 @@
+#include "tilemap/generation.h"
+#include "tilemap/lazy_tilemap.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <cstdint>
+
+using namespace istd;
+
+namespace {
+
+constexpr ChunkCoord map_size = 12;
+constexpr ChunkCoord region_size = 4;
+constexpr ChunkCoord halo = 1;
+
+GenerationConfig make_config(const char *seed) {
+	GenerationConfig config;
+	config.seed = Seed::from_string(seed);
+	return config;
+}
+
+bool same_tiles(const Chunk &a, const Chunk &b) {
+	for (std::uint8_t x = 0; x < Chunk::size; ++x) {
+		for (std::uint8_t y = 0; y < Chunk::size; ++y) {
+			if (a.tiles[x][y] != b.tiles[x][y]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool same_base_tiles(const Chunk &a, const Chunk &b) {
+	for (std::uint8_t x = 0; x < Chunk::size; ++x) {
+		for (std::uint8_t y = 0; y < Chunk::size; ++y) {
+			if (a.tiles[x][y].base != b.tiles[x][y].base) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool same_biomes(const Chunk &a, const Chunk &b) {
+	for (std::uint8_t x = 0; x < Chunk::subchunk_count; ++x) {
+		for (std::uint8_t y = 0; y < Chunk::subchunk_count; ++y) {
+			if (a.biome[x][y] != b.biome[x][y]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+TEST_CASE("LazyTileMap does not depend on request order", "[lazy_tilemap]") {
+	const GenerationConfig config = make_config(
+		GENERATE("hello_world", "lazy")
+	);
+
+	LazyTileMap in_order(map_size, config, region_size, halo);
+	in_order.generate_area(0, 0, map_size, map_size);
+
+	// Start with the corner where four regions meet, then walk the remaining
+	// chunks backwards
+	LazyTileMap reversed(map_size, config, region_size, halo);
+	reversed.generate_area(3, 3, 2, 2);
+	REQUIRE(reversed.generated_region_count() == 4);
+	for (ChunkCoord chunk_x = map_size; chunk_x-- > 0;) {
+		for (ChunkCoord chunk_y = map_size; chunk_y-- > 0;) {
+			reversed.get_chunk(chunk_x, chunk_y);
+		}
+	}
+
+	const ChunkCoord regions = map_size / region_size;
+	REQUIRE(in_order.generated_region_count() == regions * regions);
+	REQUIRE(reversed.generated_region_count() == regions * regions);
+	for (ChunkCoord chunk_x = 0; chunk_x < map_size; ++chunk_x) {
+		for (ChunkCoord chunk_y = 0; chunk_y < map_size; ++chunk_y) {
+			const Chunk &a = in_order.tilemap().get_chunk(chunk_x, chunk_y);
+			const Chunk &b = reversed.tilemap().get_chunk(chunk_x, chunk_y);
+			REQUIRE(same_tiles(a, b));
+			REQUIRE(same_biomes(a, b));
+		}
+	}
+}
+
+TEST_CASE("LazyTileMap terrain matches map_generate", "[lazy_tilemap]") {
+	const GenerationConfig config = make_config(
+		GENERATE("hello_world", "lazy")
+	);
+
+	TileMap eager(map_size);
+	map_generate(eager, config);
+
+	// The middle region has a full halo on every side; resource clusters
+	// are sampled per window, so only base tiles and biomes are compared
+	LazyTileMap lazy(map_size, config, region_size, halo);
+	for (ChunkCoord chunk_x = region_size; chunk_x < 2 * region_size;
+	     ++chunk_x) {
+		for (ChunkCoord chunk_y = region_size; chunk_y < 2 * region_size;
+		     ++chunk_y) {
+			const Chunk &chunk = lazy.get_chunk(chunk_x, chunk_y);
+			REQUIRE(same_base_tiles(chunk, eager.get_chunk(chunk_x, chunk_y)));
+			REQUIRE(same_biomes(chunk, eager.get_chunk(chunk_x, chunk_y)));
+		}
+	}
+	REQUIRE(lazy.generated_region_count() == 1);
+}
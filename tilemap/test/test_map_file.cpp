@@ -0,0 +1,165 @@
+#include "tilemap/compact_chunk.h"
+#include "tilemap/generation.h"
+#include "tilemap/map_file.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+using namespace istd;
+
+namespace {
+
+constexpr ChunkCoord map_size = 3;
+
+TileMap generated_map() {
+	TileMap tilemap(map_size);
+	GenerationConfig config;
+	config.seed = Seed::from_string("map_file");
+	map_generate(tilemap, config);
+	return tilemap;
+}
+
+std::filesystem::path temp_path(std::string_view name) {
+	return std::filesystem::temp_directory_path() / name;
+}
+
+bool same_chunk(const Chunk &a, const Chunk &b) {
+	for (std::uint8_t x = 0; x < Chunk::size; ++x) {
+		for (std::uint8_t y = 0; y < Chunk::size; ++y) {
+			if (a.tiles[x][y] != b.tiles[x][y]) {
+				return false;
+			}
+		}
+	}
+	for (std::uint8_t x = 0; x < Chunk::subchunk_count; ++x) {
+		for (std::uint8_t y = 0; y < Chunk::subchunk_count; ++y) {
+			if (a.biome[x][y] != b.biome[x][y]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool same_map(const TileMap &a, const TileMap &b) {
+	if (a.get_size() != b.get_size()) {
+		return false;
+	}
+	for (ChunkCoord chunk_x = 0; chunk_x < a.get_size(); ++chunk_x) {
+		for (ChunkCoord chunk_y = 0; chunk_y < a.get_size(); ++chunk_y) {
+			if (!same_chunk(
+				    a.get_chunk(chunk_x, chunk_y), b.get_chunk(chunk_x, chunk_y)
+			    )) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+std::uint32_t crc32_of(std::string_view text) {
+	return map_file::crc32(
+		{reinterpret_cast<const std::uint8_t *>(text.data()), text.size()}
+	);
+}
+
+} // namespace
+
+TEST_CASE("crc32 matches known vectors", "[map_file]") {
+	REQUIRE(crc32_of("") == 0x00000000);
+	REQUIRE(crc32_of("a") == 0xE8B7BE43);
+	REQUIRE(crc32_of("123456789") == 0xCBF43926);
+	REQUIRE(
+		crc32_of("The quick brown fox jumps over the lazy dog") == 0x414FA339
+	);
+}
+
+TEST_CASE("tilemap files round trip", "[map_file]") {
+	const TileMap original = generated_map();
+
+	SECTION("raw records") {
+		const auto path = temp_path("istd_test_map_file_raw.tilemap");
+		save_tilemap(path, original, 42);
+
+		REQUIRE(TileMapReader(path).user_key() == 42);
+		REQUIRE(TileMapReader(path).is_contiguous());
+		REQUIRE(same_map(load_tilemap(path), original));
+
+		TileMap compact_loaded(map_size);
+		load_compact_tilemap(path).decompress(compact_loaded);
+		REQUIRE(same_map(compact_loaded, original));
+		std::filesystem::remove(path);
+	}
+
+	SECTION("palette records") {
+		const auto path = temp_path("istd_test_map_file_palette.tilemap");
+		save_tilemap(path, CompactTileMap(original));
+
+		REQUIRE_FALSE(TileMapReader(path).is_contiguous());
+		REQUIRE(same_map(load_tilemap(path), original));
+
+		TileMap compact_loaded(map_size);
+		load_compact_tilemap(path).decompress(compact_loaded);
+		REQUIRE(same_map(compact_loaded, original));
+		std::filesystem::remove(path);
+	}
+}
+
+TEST_CASE("read_all fast path matches per-record reads", "[map_file]") {
+	const TileMap original = generated_map();
+	const auto path = temp_path("istd_test_map_file_read_all.tilemap");
+	save_tilemap(path, original);
+
+	// An eager map takes the single-read path
+	TileMapReader reader(path);
+	TileMap eager(map_size);
+	reader.read_all(eager);
+
+	// An on-demand map has no chunk array and reads record by record
+	TileMap on_demand(map_size, ChunkAllocation::OnDemand);
+	reader.read_all(on_demand);
+
+	REQUIRE(same_map(eager, original));
+	REQUIRE(same_map(on_demand, original));
+	for (ChunkCoord chunk_x = 0; chunk_x < map_size; ++chunk_x) {
+		for (ChunkCoord chunk_y = 0; chunk_y < map_size; ++chunk_y) {
+			Chunk chunk;
+			reader.read_chunk(chunk_x, chunk_y, chunk);
+			REQUIRE(same_chunk(chunk, eager.get_chunk(chunk_x, chunk_y)));
+		}
+	}
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("corrupted records are rejected", "[map_file]") {
+	const TileMap original = generated_map();
+	const auto path = temp_path("istd_test_map_file_corrupt.tilemap");
+	save_tilemap(path, original);
+
+	// Flip a byte inside the record of chunk (0, 1)
+	const std::uint64_t offset = TileMapReader(path).data_offset()
+		+ map_file::raw_record_size + 100;
+	{
+		std::fstream file(
+			path, std::ios::binary | std::ios::in | std::ios::out
+		);
+		file.seekg(offset);
+		const char byte = static_cast<char>(file.get());
+		file.seekp(offset);
+		file.put(static_cast<char>(byte ^ 0x5A));
+	}
+
+	REQUIRE_THROWS_AS(load_tilemap(path), std::runtime_error);
+
+	TileMapReader reader(path);
+	TileMap on_demand(map_size, ChunkAllocation::OnDemand);
+	REQUIRE_THROWS_AS(reader.read_all(on_demand), std::runtime_error);
+
+	Chunk chunk;
+	REQUIRE_THROWS_AS(reader.read_chunk(0, 1, chunk), std::runtime_error);
+	REQUIRE_NOTHROW(reader.read_chunk(0, 0, chunk));
+	std::filesystem::remove(path);
+}
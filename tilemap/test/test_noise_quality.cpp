@@ -0,0 +1,110 @@
+#include "tilemap/noise.h"
+#include "tilemap/xoroshiro.h"
+#include <algorithm>
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace istd;
+
+namespace {
+
+constexpr std::uint32_t avalanche_samples = 4096;
+constexpr std::uint32_t grid_size = 256;
+
+// Largest acceptable |P(output bit flips) - 0.5| over all input/output bit
+// pairs; one sample cell has a standard deviation of about 0.008
+constexpr double avalanche_limit = 0.05;
+
+// Chi-square limit for 255 degrees of freedom, about 4 standard deviations
+// above the mean
+constexpr double chi_square_limit = 350.0;
+
+// Flip every one of the 96 input bits of random coordinates and measure how
+// often every output bit flips. An ideal hash flips each with probability 1/2.
+// Returns the worst bias over all input/output bit pairs.
+double worst_avalanche_bias(
+	const DiscreteRandomNoise &noise, Xoroshiro128PP &rng
+) {
+	std::vector<std::uint32_t> flips(96 * 64);
+	for (std::uint32_t i = 0; i < avalanche_samples; ++i) {
+		std::uint64_t a = rng.next(), b = rng.next();
+		std::array<std::uint32_t, 3> coord{
+			static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(a >> 32),
+			static_cast<std::uint32_t>(b)
+		};
+		const std::uint64_t base = noise.noise(coord[0], coord[1], coord[2]);
+
+		for (int in_bit = 0; in_bit < 96; ++in_bit) {
+			auto flipped = coord;
+			flipped[in_bit / 32] ^= 1u << (in_bit % 32);
+			std::uint64_t diff
+				= base ^ noise.noise(flipped[0], flipped[1], flipped[2]);
+			for (int out_bit = 0; out_bit < 64; ++out_bit) {
+				flips[in_bit * 64 + out_bit] += (diff >> out_bit) & 1;
+			}
+		}
+	}
+
+	double worst = 0.0;
+	for (std::uint32_t count : flips) {
+		double bias = std::abs(
+			static_cast<double>(count) / avalanche_samples - 0.5
+		);
+		worst = std::max(worst, bias);
+	}
+	return worst;
+}
+
+// Hash a dense grid of coordinates, as the generation passes do, and return
+// the chi-square statistic of every output byte over its 256 values
+std::array<double, 8> byte_chi_squares(const DiscreteRandomNoise &noise) {
+	std::vector<std::array<std::uint32_t, 256>> buckets(8);
+	for (auto &bucket : buckets) {
+		bucket.fill(0);
+	}
+	for (std::uint32_t x = 0; x < grid_size; ++x) {
+		for (std::uint32_t y = 0; y < grid_size; ++y) {
+			std::uint64_t value = noise.noise(x, y, 0);
+			for (int byte = 0; byte < 8; ++byte) {
+				++buckets[byte][(value >> (byte * 8)) & 0xFF];
+			}
+		}
+	}
+
+	const double expected = grid_size * grid_size / 256.0;
+	std::array<double, 8> chi_squares{};
+	for (int byte = 0; byte < 8; ++byte) {
+		for (std::uint32_t count : buckets[byte]) {
+			double delta = count - expected;
+			chi_squares[byte] += delta * delta / expected;
+		}
+	}
+	return chi_squares;
+}
+
+} // namespace
+
+TEST_CASE("DiscreteRandomNoise statistical quality", "[noise]") {
+	auto backend = GENERATE(
+		NoiseBackend::Permutation, NoiseBackend::MultiplyXorshift
+	);
+	CAPTURE(static_cast<int>(backend));
+
+	Xoroshiro128PP rng(Seed::from_string("noise_quality"));
+	DiscreteRandomNoise noise(rng.jump_96(), backend);
+	rng = rng.jump_96();
+
+	SECTION("avalanche") {
+		REQUIRE(worst_avalanche_bias(noise, rng) < avalanche_limit);
+	}
+
+	SECTION("byte buckets") {
+		for (double chi_square : byte_chi_squares(noise)) {
+			REQUIRE(chi_square < chi_square_limit);
+		}
+	}
+}
@@ -2,12 +2,213 @@
 #define ISTD_UTIL_TILE_GEOMETRY_H
 
 #include "istd_util/vec2.h"
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <generator>
+#include <limits>
+#include <optional>
 
 namespace istd {
 
+/**
+ * @brief Walks the tiles traversed by a line segment one at a time
+ *
+ * Allocation-free form of the Amanatides-Woo traversal behind
+ * tiles_on_segment(), defined inline so hot loops can use it without a
+ * coroutine frame per segment. Starts at the tile of the first endpoint and
+ * ends at the tile of the second one.
+ *
+ * @note x points downward, y points rightward,
+ * i.e. x is row index, y is column index.
+ */
+class SegmentTileWalker {
+private:
+	std::int32_t i_;
+	std::int32_t j_;
+	std::int32_t end_i_;
+	std::int32_t end_j_;
+	std::int32_t step_x_ = 0;
+	std::int32_t step_y_ = 0;
+	float t_max_x_ = std::numeric_limits<float>::infinity();
+	float t_max_y_ = std::numeric_limits<float>::infinity();
+	float t_delta_x_ = std::numeric_limits<float>::infinity();
+	float t_delta_y_ = std::numeric_limits<float>::infinity();
+	// Unit steps left to the last tile; bounds the walk even if rounding
+	// makes it miss the last tile
+	std::uint32_t remaining_;
+
+public:
+	SegmentTileWalker(Vec2 p1, Vec2 p2) noexcept
+		: i_(static_cast<std::int32_t>(std::floor(p1.x)))
+		, j_(static_cast<std::int32_t>(std::floor(p1.y))) {
+		end_i_ = static_cast<std::int32_t>(std::floor(p2.x));
+		end_j_ = static_cast<std::int32_t>(std::floor(p2.y));
+		remaining_ = static_cast<std::uint32_t>(
+			std::abs(end_i_ - i_) + std::abs(end_j_ - j_)
+		);
+
+		const float delta_x = p2.x - p1.x;
+		const float delta_y = p2.y - p1.y;
+		if (delta_x > 0) {
+			step_x_ = 1;
+			t_max_x_ = (i_ + 1 - p1.x) / delta_x;
+			t_delta_x_ = 1.0f / delta_x;
+		} else if (delta_x < 0) {
+			step_x_ = -1;
+			t_max_x_ = (i_ - p1.x) / delta_x;
+			t_delta_x_ = -1.0f / delta_x;
+		}
+		if (delta_y > 0) {
+			step_y_ = 1;
+			t_max_y_ = (j_ + 1 - p1.y) / delta_y;
+			t_delta_y_ = 1.0f / delta_y;
+		} else if (delta_y < 0) {
+			step_y_ = -1;
+			t_max_y_ = (j_ - p1.y) / delta_y;
+			t_delta_y_ = -1.0f / delta_y;
+		}
+	}
+
+	/**
+	 * @brief Get the current tile as (i, j)
+	 */
+	std::array<std::int32_t, 2> tile() const noexcept {
+		return {i_, j_};
+	}
+
+	/**
+	 * @brief Check if the current tile is the last one
+	 */
+	bool done() const noexcept {
+		return remaining_ == 0;
+	}
+
+	/**
+	 * @brief Get the number of unit steps from the current tile to the last
+	 * one, a diagonal step counting as two
+	 */
+	std::uint32_t remaining_steps() const noexcept {
+		return remaining_;
+	}
+
+	/**
+	 * @brief Move to the next tile, must not be called once done()
+	 */
+	void next() noexcept {
+		if (std::abs(t_max_x_ - t_max_y_) < 1e-6f) {
+			// Passing through a corner, step both axes at once
+			i_ += step_x_;
+			j_ += step_y_;
+			t_max_x_ += t_delta_x_;
+			t_max_y_ += t_delta_y_;
+			remaining_ -= std::min<std::uint32_t>(remaining_, 2);
+		} else if (t_max_x_ < t_max_y_) {
+			i_ += step_x_;
+			t_max_x_ += t_delta_x_;
+			--remaining_;
+		} else {
+			j_ += step_y_;
+			t_max_y_ += t_delta_y_;
+			--remaining_;
+		}
+	}
+
+	/**
+	 * @brief Jump to the first tile past the block holding the current tile
+	 *
+	 * Blocks are the aligned squares [k * block_size, (k + 1) * block_size)
+	 * on both axes. The tiles skipped inside the block are not visited. The
+	 * jump computes the crossings in one step rather than adding them up, so
+	 * it can differ from calling next() where the segment passes within
+	 * rounding of a tile corner.
+	 *
+	 * @param block_size Side of a block in tiles, a power of two
+	 * @return False if the segment ends inside the block; the walker is then
+	 * done() and stays at the current tile
+	 */
+	bool skip_block(std::int32_t block_size) noexcept {
+		const std::int32_t lo_i = i_ & -block_size;
+		const std::int32_t lo_j = j_ & -block_size;
+		if ((end_i_ & -block_size) == lo_i && (end_j_ & -block_size) == lo_j) {
+			remaining_ = 0;
+			return false;
+		}
+
+		// Crossings until the walk leaves the block along each axis; the
+		// last one is at t_max + (count - 1) * t_delta
+		const std::int32_t n_x = step_x_ > 0 ? lo_i + block_size - i_
+			: step_x_ < 0                    ? i_ - lo_i + 1
+			                                 : 0;
+		const std::int32_t n_y = step_y_ > 0 ? lo_j + block_size - j_
+			: step_y_ < 0                    ? j_ - lo_j + 1
+			                                 : 0;
+		const float exit_x = n_x ? t_max_x_ + (n_x - 1) * t_delta_x_
+		                         : t_max_x_;
+		const float exit_y = n_y ? t_max_y_ + (n_y - 1) * t_delta_y_
+		                         : t_max_y_;
+
+		// Catch the other axis up to the exit by adding, as next() does;
+		// it crosses at most block_size - 1 times inside the block
+		std::int32_t k_x = 0;
+		std::int32_t k_y = 0;
+		if (std::abs(exit_x - exit_y) < 1e-6f) {
+			k_x = n_x;
+			k_y = n_y;
+			t_max_x_ += n_x * t_delta_x_;
+			t_max_y_ += n_y * t_delta_y_;
+		} else if (exit_x < exit_y) {
+			k_x = n_x;
+			t_max_x_ += n_x * t_delta_x_;
+			while (t_max_y_ < exit_x && k_y < n_y - 1) {
+				t_max_y_ += t_delta_y_;
+				++k_y;
+			}
+		} else {
+			k_y = n_y;
+			t_max_y_ += n_y * t_delta_y_;
+			while (t_max_x_ < exit_y && k_x < n_x - 1) {
+				t_max_x_ += t_delta_x_;
+				++k_x;
+			}
+		}
+
+		i_ += step_x_ * k_x;
+		j_ += step_y_ * k_y;
+		const auto steps = static_cast<std::uint32_t>(k_x + k_y);
+		remaining_ -= std::min(remaining_, steps);
+		return true;
+	}
+};
+
+/**
+ * @brief Finds the first tile traversed by a line segment that satisfies a
+ * predicate, stopping the walk there
+ *
+ * @param p1 The starting point of the segment (floating point coordinates).
+ * @param p2 The ending point of the segment (floating point coordinates).
+ * @param pred Called as pred(i, j) for each tile in order from p1 to p2.
+ * @return The first tile for which pred returned true, or std::nullopt.
+ */
+template<typename Predicate>
+std::optional<std::array<std::int32_t, 2>> find_tile_on_segment(
+	Vec2 p1, Vec2 p2, Predicate &&pred
+) {
+	SegmentTileWalker walker(p1, p2);
+	while (true) {
+		const auto tile = walker.tile();
+		if (pred(tile[0], tile[1])) {
+			return tile;
+		}
+		if (walker.done()) {
+			return std::nullopt;
+		}
+		walker.next();
+	}
+}
+
 /**
  * @brief Iterates all tile coordinates traversed by a line segment on a
  * tilemap.
@@ -23,6 +224,8 @@ namespace istd {
  * @param p2 The ending point of the segment (floating point coordinates).
  * @return Generator yielding (i, j) tuples for each tile crossed by the
  * segment.
+ * @note Allocates a coroutine frame; hot loops should use SegmentTileWalker
+ * or find_tile_on_segment() instead.
  */
 std::generator<std::array<std::int32_t, 2>> tiles_on_segment(
 	Vec2 p1, Vec2 p2
@@ -1,4 +1,6 @@
 #include "istd_util/tile_geometry.h"
+#include <algorithm>
+#include <array>
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <tuple>
@@ -68,6 +70,94 @@ TEST_CASE("tiles_on_segment function", "[tile_geometry]") {
 	}
 }
 
+TEST_CASE("SegmentTileWalker and find_tile_on_segment", "[tile_geometry]") {
+	auto walk = [](Vec2 p1, Vec2 p2) {
+		std::vector<std::tuple<int, int>> result;
+		SegmentTileWalker walker(p1, p2);
+		result.emplace_back(walker.tile()[0], walker.tile()[1]);
+		while (!walker.done()) {
+			walker.next();
+			result.emplace_back(walker.tile()[0], walker.tile()[1]);
+		}
+		return result;
+	};
+
+	SECTION("walker visits the crossed tiles in order") {
+		// Crosses x = 2..6 at t = 0.14, 0.35, 0.55, 0.76, 0.96 and
+		// y = 7..3 at t = 0.16, 0.35, 0.53, 0.71, 0.89
+		const std::vector<std::tuple<int, int>> expected{
+			{1, 7}, {2, 7}, {2, 6}, {2, 5}, {3, 5}, {3, 4},
+			{4, 4}, {4, 3}, {5, 3}, {5, 2}, {6, 2},
+		};
+		REQUIRE(walk(Vec2(1.3f, 7.9f), Vec2(6.2f, 2.4f)) == expected);
+	}
+
+	SECTION("walker steps diagonally through corners") {
+		// Passes exactly through the corners (1, 2) and (2, 4)
+		const std::vector<std::tuple<int, int>> expected{
+			{0, 0}, {0, 1}, {1, 2}, {1, 3}, {2, 4},
+		};
+		REQUIRE(walk(Vec2(0.25f, 0.5f), Vec2(2.25f, 4.5f)) == expected);
+	}
+
+	SECTION("skip_block jumps past the block") {
+		Vec2 p1(1.5f, 0.5f);
+		Vec2 p2(1.5f, 20.5f);
+		SegmentTileWalker walker(p1, p2);
+		REQUIRE(walker.skip_block(8));
+		REQUIRE(walker.tile() == std::array<std::int32_t, 2>{1, 8});
+		REQUIRE(walker.remaining_steps() == 12);
+		REQUIRE(walker.skip_block(8));
+		REQUIRE(walker.tile() == std::array<std::int32_t, 2>{1, 16});
+
+		// The segment ends in this block
+		REQUIRE_FALSE(walker.skip_block(8));
+		REQUIRE(walker.done());
+	}
+
+	SECTION("skip_block matches stepping") {
+		Vec2 p1(0.3f, 0.6f);
+		Vec2 p2(9.8f, 5.1f);
+		std::vector<std::array<std::int32_t, 2>> tiles;
+		for (auto tile : tiles_on_segment(p1, p2)) {
+			tiles.push_back(tile);
+		}
+
+		SegmentTileWalker walker(p1, p2);
+		REQUIRE(walker.skip_block(4));
+		// First tile of the walk outside the block [0, 4) x [0, 4)
+		auto outside = std::ranges::find_if(tiles, [](auto tile) {
+			return tile[0] >= 4 || tile[1] >= 4;
+		});
+		REQUIRE(walker.tile() == *outside);
+	}
+
+	SECTION("find stops at the first match") {
+		Vec2 p1(0.5f, 1.2f);
+		Vec2 p2(0.5f, 4.8f);
+		int visited = 0;
+		auto hit = find_tile_on_segment(p1, p2, [&](int, int j) {
+			++visited;
+			return j >= 3;
+		});
+
+		REQUIRE(hit.has_value());
+		REQUIRE((*hit)[0] == 0);
+		REQUIRE((*hit)[1] == 3);
+		REQUIRE(visited == 3);
+	}
+
+	SECTION("find without a match") {
+		Vec2 p1(7.3f, 8.9f);
+		Vec2 p2(7.7f, 8.1f);
+		auto hit = find_tile_on_segment(p1, p2, [](int, int) {
+			return false;
+		});
+
+		REQUIRE_FALSE(hit.has_value());
+	}
+}
+
 TEST_CASE("tile_segment_intersection function", "[tile_geometry]") {
 	SECTION("horizontal segment intersection") {
 		Vec2 p1(0.5f, 1.2f);